@@ -0,0 +1,56 @@
+/*
+Thread pool used by the Small Matrix program for parallel and asynchronous work.
+*/
+
+#include "Executor.hpp"
+#include <algorithm>
+namespace smallMatrix {
+
+Executor& Executor::instance() {
+    static Executor executor(std::thread::hardware_concurrency());
+    return executor;
+}
+
+Executor::Executor(int numThreads)
+    :   mStopping {false} {
+    for (int i {}; i < std::max(1, numThreads); i++) {
+        mWorkers.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+Executor::~Executor() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mTaskAvailable.notify_all();
+    std::for_each(mWorkers.begin(), mWorkers.end(), [](auto& worker) { worker.join(); });
+}
+
+void Executor::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mTasks.push_back(std::move(task));
+    }
+    mTaskAvailable.notify_one();
+}
+
+int Executor::numThreads() const { return mWorkers.size(); }
+
+void Executor::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mTaskAvailable.wait(lock, [this]() { return mStopping || !mTasks.empty(); });
+            if (mTasks.empty()) {
+                return;
+            }
+            task = std::move(mTasks.front());
+            mTasks.pop_front();
+        }
+        task();
+    }
+}
+
+}  // namespace smallMatrix
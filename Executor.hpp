@@ -0,0 +1,70 @@
+/**
+ * @file Executor.hpp
+ * @author Mohamad Baydoun
+ * @brief Header file for Executor.cpp
+ */
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace smallMatrix {
+
+class Executor {
+public:
+    /**
+     * @brief Returns the library-wide executor, whose worker threads are started on first use and
+     *        joined when the program exits.
+     *
+     * @return Executor&
+     */
+    static Executor& instance();
+
+    /**
+     * @brief A constructor which starts the specified number of worker threads.
+     *
+     * @param numThreads Number of worker threads, at least one thread is always started.
+     */
+    explicit Executor(int numThreads);
+
+    Executor(Executor const&) = delete;
+    Executor& operator=(Executor const&) = delete;
+
+    /**
+     * @brief Destructor. Runs every task that is still queued, then joins the worker threads.
+     */
+    ~Executor();
+
+    /**
+     * @brief Queues a task to be run by one of the worker threads. Exceptions must not escape the
+     *        task.
+     *
+     * @param task Task to run.
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * @brief Returns the number of worker threads.
+     *
+     * @return int
+     */
+    int numThreads() const;
+
+private:
+    /**
+     * @brief Runs queued tasks until the executor is stopped and the queue is empty.
+     */
+    void workerLoop();
+
+    std::vector<std::thread> mWorkers;
+    std::deque<std::function<void()>> mTasks;
+    std::mutex mMutex;
+    std::condition_variable mTaskAvailable;
+    bool mStopping;
+};
+
+}  // namespace smallMatrix
@@ -0,0 +1,455 @@
+/*
+File-backed storage and out-of-core multiplication for the Small Matrix program.
+*/
+
+#include "MappedMatrix.hpp"
+#include "Executor.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+namespace smallMatrix {
+
+namespace {
+
+constexpr char fileMagic[8] {'S', 'M', 'M', 'A', 'T', 'R', 'I', 'X'};
+constexpr std::int32_t fileVersion = 1;
+
+// The header takes up a whole page, so that tiles start on a page boundary
+constexpr std::size_t headerSize = 4096;
+
+struct FileHeader {
+    char magic[8];
+    std::int32_t version;
+    std::int32_t numRows;
+    std::int32_t numCols;
+    std::int32_t tileSize;
+};
+
+// Returns the number of tiles covering the specified number of rows or columns. The sum is formed
+// in 64 bits, as the sizes may come from the header of an untrusted file.
+int numTilesCovering(int size, int tileSize) {
+    return static_cast<int>((static_cast<std::int64_t>(size) + tileSize - 1) / tileSize);
+}
+
+// Returns the size of the file for a matrix with the specified dimensions, or 0 if it would not fit
+// in a file offset or in the address space
+std::size_t mappingSize(int numRows, int numCols, int tileSize) {
+    const std::uint64_t maxSize = std::min<std::uint64_t>(std::numeric_limits<off_t>::max(),
+                                                          std::numeric_limits<std::size_t>::max());
+    const std::uint64_t numTiles = static_cast<std::uint64_t>(numTilesCovering(numRows, tileSize)) *
+                                   static_cast<std::uint64_t>(numTilesCovering(numCols, tileSize));
+    const std::uint64_t numTileElements = static_cast<std::uint64_t>(tileSize) * static_cast<std::uint64_t>(tileSize);
+    if (numTileElements > (maxSize - headerSize) / sizeof(double)) {
+        return 0;
+    }
+    const std::uint64_t tileBytes = numTileElements * sizeof(double);
+    if (numTiles > (maxSize - headerSize) / tileBytes) {
+        return 0;
+    }
+    return static_cast<std::size_t>(headerSize + numTiles * tileBytes);
+}
+
+// Returns the whole pages holding the specified elements, as madvise and msync need page-aligned
+// addresses. Pages shared with a neighbouring tile are only read again if they are dropped.
+std::pair<void*, std::size_t> pageRange(double const* first, std::size_t count) {
+    static const std::uintptr_t pageSize = static_cast<std::uintptr_t>(::sysconf(_SC_PAGESIZE));
+    const std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(first) / pageSize * pageSize;
+    const std::uintptr_t end = reinterpret_cast<std::uintptr_t>(first + count);
+    return std::make_pair(reinterpret_cast<void*>(begin), static_cast<std::size_t>((end - begin + pageSize - 1) / pageSize * pageSize));
+}
+
+// Reads a pair of operand tiles once. The load is queued on the executor, and whichever of the
+// worker and the multiplying thread claims it first runs it, so waiting for it cannot deadlock
+// when the multiplication itself runs on the executor.
+struct TileLoad {
+    std::function<void()> load;
+    std::atomic<bool> claimed {false};
+    std::mutex mutex;
+    std::condition_variable finished;
+    bool done {false};
+    std::exception_ptr error;
+    SmallMatrix lhsTile;
+    SmallMatrix rhsTile;
+};
+
+void runTileLoad(TileLoad& state) {
+    if (state.claimed.exchange(true)) {
+        return;
+    }
+    std::exception_ptr error;
+    try {
+        state.load();
+    } catch (...) {
+        error = std::current_exception();
+    }
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.error = error;
+        state.done = true;
+    }
+    state.finished.notify_all();
+}
+
+void waitForTileLoad(TileLoad& state) {
+    runTileLoad(state);
+    std::unique_lock<std::mutex> lock(state.mutex);
+    state.finished.wait(lock, [&]() { return state.done; });
+    if (state.error) {
+        std::rethrow_exception(state.error);
+    }
+}
+
+}  // namespace
+
+
+MappedMatrix::MappedMatrix(std::string const& path, int numRows, int numCols, int tileSize)
+    :   mPath {path},
+        mFile {-1},
+        mIsWritable {true},
+        mNumRows {numRows},
+        mNumCols {numCols},
+        mTileSize {tileSize},
+        mNumTileRows {},
+        mNumTileCols {},
+        mMappingSize {},
+        mData {nullptr},
+        mMapping {nullptr} {
+    if (numRows < 0 || numCols < 0) {
+        throw std::out_of_range("Out of Range! Illegal row or column size");
+    }
+    if (tileSize <= 0) {
+        throw std::out_of_range("Out of Range! Illegal tile size");
+    }
+    mNumTileRows = numTilesCovering(numRows, tileSize);
+    mNumTileCols = numTilesCovering(numCols, tileSize);
+    mMappingSize = mappingSize(numRows, numCols, tileSize);
+    if (mMappingSize == 0) {
+        throw std::runtime_error("Matrix file would be too large!");
+    }
+
+    // Extending the file with ftruncate leaves it sparse, so the zero tiles take no disk space
+    // until they are written
+    mFile = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (mFile < 0) {
+        throw std::runtime_error("Could not create matrix file!");
+    }
+    if (::ftruncate(mFile, static_cast<off_t>(mMappingSize)) != 0) {
+        release();
+        throw std::runtime_error("Could not create matrix file!");
+    }
+    map();
+
+    FileHeader header {};
+    std::memcpy(header.magic, fileMagic, sizeof(fileMagic));
+    header.version = fileVersion;
+    header.numRows = numRows;
+    header.numCols = numCols;
+    header.tileSize = tileSize;
+    std::memcpy(mMapping, &header, sizeof(header));
+}
+
+MappedMatrix::MappedMatrix(std::string const& path, SmallMatrix const& sm, int tileSize)
+    :   MappedMatrix(path, sm.size().first, sm.size().second, tileSize) {
+    for (int i {}; i < mNumRows; i++) {
+        double const* row = detail::rowData(sm, i);
+        for (int tileCol {}; tileCol < mNumTileCols; tileCol++) {
+            const int firstCol = tileCol * mTileSize;
+            const int lastCol = firstCol + std::min(mTileSize, mNumCols - firstCol);
+            std::copy(row + firstCol, row + lastCol, tileData(i / mTileSize, tileCol) + static_cast<std::size_t>(i % mTileSize) * mTileSize);
+        }
+    }
+}
+
+MappedMatrix::MappedMatrix(std::string const& path, bool writable)
+    :   mPath {path},
+        mFile {-1},
+        mIsWritable {writable},
+        mNumRows {},
+        mNumCols {},
+        mTileSize {},
+        mNumTileRows {},
+        mNumTileCols {},
+        mMappingSize {},
+        mData {nullptr},
+        mMapping {nullptr} {
+    mFile = ::open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+    if (mFile < 0) {
+        throw std::runtime_error("Could not open matrix file!");
+    }
+
+    FileHeader header {};
+    struct stat status {};
+    const bool isHeader = ::pread(mFile, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+                          std::memcmp(header.magic, fileMagic, sizeof(fileMagic)) == 0 &&
+                          header.version == fileVersion && header.numRows >= 0 && header.numCols >= 0 &&
+                          header.tileSize > 0;
+
+    // A corrupt header may give dimensions whose size overflows, which must not pass the check
+    // against the size of the file
+    const std::size_t size = isHeader ? mappingSize(header.numRows, header.numCols, header.tileSize) : 0;
+    const bool isMatrixFile = size != 0 && ::fstat(mFile, &status) == 0 &&
+                              static_cast<std::uint64_t>(status.st_size) >= size;
+    if (!isMatrixFile) {
+        release();
+        throw std::runtime_error("Not a matrix file!");
+    }
+    mNumRows = header.numRows;
+    mNumCols = header.numCols;
+    mTileSize = header.tileSize;
+    mNumTileRows = numTilesCovering(mNumRows, mTileSize);
+    mNumTileCols = numTilesCovering(mNumCols, mTileSize);
+    mMappingSize = size;
+    map();
+}
+
+MappedMatrix::MappedMatrix(MappedMatrix&& other) noexcept
+    :   mPath {std::move(other.mPath)},
+        mFile {other.mFile},
+        mIsWritable {other.mIsWritable},
+        mNumRows {other.mNumRows},
+        mNumCols {other.mNumCols},
+        mTileSize {other.mTileSize},
+        mNumTileRows {other.mNumTileRows},
+        mNumTileCols {other.mNumTileCols},
+        mMappingSize {other.mMappingSize},
+        mData {other.mData},
+        mMapping {other.mMapping} {
+    other.mFile = -1;
+    other.mData = nullptr;
+    other.mMapping = nullptr;
+    other.mNumRows = other.mNumCols = other.mNumTileRows = other.mNumTileCols = 0;
+}
+
+MappedMatrix& MappedMatrix::operator=(MappedMatrix&& other) noexcept {
+    if (this != &other) {
+        release();
+        mPath = std::move(other.mPath);
+        mFile = other.mFile;
+        mIsWritable = other.mIsWritable;
+        mNumRows = other.mNumRows;
+        mNumCols = other.mNumCols;
+        mTileSize = other.mTileSize;
+        mNumTileRows = other.mNumTileRows;
+        mNumTileCols = other.mNumTileCols;
+        mMappingSize = other.mMappingSize;
+        mData = other.mData;
+        mMapping = other.mMapping;
+        other.mFile = -1;
+        other.mData = nullptr;
+        other.mMapping = nullptr;
+        other.mNumRows = other.mNumCols = other.mNumTileRows = other.mNumTileCols = 0;
+    }
+    return *this;
+}
+
+MappedMatrix::~MappedMatrix() {
+    release();
+}
+
+void MappedMatrix::map() {
+    void* mapping = ::mmap(nullptr, mMappingSize, mIsWritable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, mFile, 0);
+    if (mapping == MAP_FAILED) {
+        release();
+        throw std::runtime_error("Could not map matrix file!");
+    }
+    mMapping = mapping;
+    mData = reinterpret_cast<double*>(static_cast<char*>(mapping) + headerSize);
+}
+
+void MappedMatrix::release() noexcept {
+    if (mMapping != nullptr) {
+        ::munmap(mMapping, mMappingSize);
+        mMapping = nullptr;
+        mData = nullptr;
+    }
+    if (mFile >= 0) {
+        ::close(mFile);
+        mFile = -1;
+    }
+}
+
+SmallMatrix MappedMatrix::toSmallMatrix() const {
+    SmallMatrix sm = SmallMatrix(mNumRows, mNumCols);
+    for (int i {}; i < mNumRows; i++) {
+        double* row = detail::rowData(sm, i);
+        for (int tileCol {}; tileCol < mNumTileCols; tileCol++) {
+            const int firstCol = tileCol * mTileSize;
+            const int lastCol = firstCol + std::min(mTileSize, mNumCols - firstCol);
+            double const* tileRow = tileData(i / mTileSize, tileCol) + static_cast<std::size_t>(i % mTileSize) * mTileSize;
+            std::copy(tileRow, tileRow + (lastCol - firstCol), row + firstCol);
+        }
+    }
+    return sm;
+}
+
+double& MappedMatrix::operator()(int numRow, int numCol) {
+    if (!mIsWritable) {
+        throw std::runtime_error("Matrix file is read-only!");
+    }
+    return const_cast<double&>(const_cast<const MappedMatrix*>(this)->operator()(numRow, numCol));
+}
+
+const double& MappedMatrix::operator()(int numRow, int numCol) const {
+    if (numRow < 0 || numRow >= mNumRows || numCol < 0 || numCol >= mNumCols) {
+        throw std::out_of_range("Out of Range!");
+    }
+    return tileData(numRow / mTileSize, numCol / mTileSize)[static_cast<std::size_t>(numRow % mTileSize) * mTileSize + numCol % mTileSize];
+}
+
+std::pair<int, int> MappedMatrix::size() const {
+    return std::make_pair(mNumRows, mNumCols);
+}
+
+int MappedMatrix::tileSize() const {
+    return mTileSize;
+}
+
+std::string const& MappedMatrix::path() const {
+    return mPath;
+}
+
+void MappedMatrix::flush() const {
+    if (mMapping != nullptr && mIsWritable && ::msync(mMapping, mMappingSize, MS_SYNC) != 0) {
+        throw std::runtime_error("Could not write matrix file!");
+    }
+}
+
+double* MappedMatrix::tileData(int tileRow, int tileCol) {
+    return const_cast<double*>(const_cast<const MappedMatrix*>(this)->tileData(tileRow, tileCol));
+}
+
+double const* MappedMatrix::tileData(int tileRow, int tileCol) const {
+    const std::size_t tile = static_cast<std::size_t>(tileRow) * mNumTileCols + tileCol;
+    return mData + tile * mTileSize * mTileSize;
+}
+
+SmallMatrix MappedMatrix::readTile(int tileRow, int tileCol) const {
+    const int rows = std::min(mTileSize, mNumRows - tileRow * mTileSize);
+    const int cols = std::min(mTileSize, mNumCols - tileCol * mTileSize);
+    SmallMatrix tile = SmallMatrix(rows, cols);
+    double const* data = tileData(tileRow, tileCol);
+    for (int i {}; i < rows; i++) {
+        double const* row = data + static_cast<std::size_t>(i) * mTileSize;
+        std::copy(row, row + cols, detail::rowData(tile, i));
+    }
+    return tile;
+}
+
+void MappedMatrix::writeTile(int tileRow, int tileCol, SmallMatrix const& tile) {
+    double* data = tileData(tileRow, tileCol);
+    for (int i {}; i < tile.size().first; i++) {
+        double const* row = detail::rowData(tile, i);
+        std::copy(row, row + tile.size().second, data + static_cast<std::size_t>(i) * mTileSize);
+    }
+
+    // Starts writing the tile back without waiting for it, then drops it from memory. Dropping
+    // pages of a shared mapping keeps their changes in the file.
+    auto const pages = pageRange(data, static_cast<std::size_t>(mTileSize) * mTileSize);
+    ::msync(pages.first, pages.second, MS_ASYNC);
+    ::madvise(pages.first, pages.second, MADV_DONTNEED);
+}
+
+void MappedMatrix::adviseTile(int tileRow, int tileCol, int advice) const {
+    auto const pages = pageRange(tileData(tileRow, tileCol), static_cast<std::size_t>(mTileSize) * mTileSize);
+    ::madvise(pages.first, pages.second, advice);
+}
+
+MappedMatrix multiply(MappedMatrix const& lhs, MappedMatrix const& rhs, std::string const& path) {
+    if (lhs.mNumCols != rhs.mNumRows) {
+        throw std::invalid_argument("Unequal dimensions!");
+    }
+    if (lhs.mTileSize != rhs.mTileSize) {
+        throw std::invalid_argument("Unequal tile sizes!");
+    }
+
+    // Creating the result would truncate an operand if path names one of their files
+    struct stat target {};
+    if (::stat(path.c_str(), &target) == 0) {
+        for (MappedMatrix const* operand : {&lhs, &rhs}) {
+            struct stat status {};
+            if (::fstat(operand->mFile, &status) == 0 && status.st_dev == target.st_dev && status.st_ino == target.st_ino) {
+                throw std::invalid_argument("Result would overwrite an operand!");
+            }
+        }
+    }
+
+    MappedMatrix result = MappedMatrix(path, lhs.mNumRows, rhs.mNumCols, lhs.mTileSize);
+    const int numTileRows = lhs.mNumTileRows;
+    const int numTileCols = rhs.mNumTileCols;
+    const int numTileInner = lhs.mNumTileCols;
+
+    // Every output tile takes numTileInner steps, each multiplying one pair of operand tiles. The
+    // pair for the next step is read while the current pair is multiplied.
+    const long long numSteps = static_cast<long long>(numTileRows) * numTileCols * numTileInner;
+    if (numSteps == 0) {
+        return result;
+    }
+    auto const startLoad = [&](long long step) {
+        const int tileInner = step % numTileInner;
+        const int tileCol = step / numTileInner % numTileCols;
+        const int tileRow = step / numTileInner / numTileCols;
+        lhs.adviseTile(tileRow, tileInner, MADV_WILLNEED);
+        rhs.adviseTile(tileInner, tileCol, MADV_WILLNEED);
+
+        auto state = std::make_shared<TileLoad>();
+        TileLoad* loaded = state.get();
+        state->load = [&lhs, &rhs, loaded, tileRow, tileCol, tileInner]() {
+            loaded->lhsTile = lhs.readTile(tileRow, tileInner);
+            loaded->rhsTile = rhs.readTile(tileInner, tileCol);
+        };
+        Executor::instance().submit([state]() { runTileLoad(*state); });
+        return state;
+    };
+
+    std::shared_ptr<TileLoad> next = startLoad(0);
+    try {
+        SmallMatrix accumulator;
+        for (long long step {}; step < numSteps; step++) {
+            const int tileInner = step % numTileInner;
+            const int tileCol = step / numTileInner % numTileCols;
+            const int tileRow = step / numTileInner / numTileCols;
+
+            std::shared_ptr<TileLoad> current = next;
+            waitForTileLoad(*current);
+            if (step + 1 < numSteps) {
+                next = startLoad(step + 1);
+            }
+
+            if (tileInner == 0) {
+                accumulator = SmallMatrix(current->lhsTile.size().first, current->rhsTile.size().second);
+            }
+            multiplyAdd(current->lhsTile, current->rhsTile, accumulator);
+            current->lhsTile = SmallMatrix();
+            current->rhsTile = SmallMatrix();
+            lhs.adviseTile(tileRow, tileInner, MADV_DONTNEED);
+            rhs.adviseTile(tileInner, tileCol, MADV_DONTNEED);
+
+            if (tileInner == numTileInner - 1) {
+                result.writeTile(tileRow, tileCol, accumulator);
+            }
+        }
+    } catch (...) {
+        // A queued load refers to the operands, so it must not outlive this call
+        try {
+            waitForTileLoad(*next);
+        } catch (...) {
+        }
+        throw;
+    }
+    return result;
+}
+
+}  // namespace smallMatrix
@@ -0,0 +1,239 @@
+/**
+ * @file MappedMatrix.hpp
+ * @author Mohamad Baydoun
+ * @brief Header file for MappedMatrix.cpp
+ */
+#pragma once
+
+#include "SmallMatrix.hpp"
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+namespace smallMatrix {
+
+/**
+ * @brief A matrix stored in a file and mapped into memory, for matrices that do not fit in RAM.
+ *        The file holds a small header followed by square tiles stored contiguously in row-major
+ *        order. Tiles on the bottom and right edges are padded with zeros. Only the pages that are
+ *        touched are read from the file, and changes are written back to it.
+ */
+class MappedMatrix {
+public:
+    /**
+     * @brief A constructor which creates, or overwrites, the specified file with a zero matrix of
+     *        the dimensions given by numRows and numCols.
+     *
+     * @param path Path of the file.
+     * @param numRows Number of rows to initialise with.
+     * @param numCols Number of columns to initialise with.
+     * @param tileSize Number of rows and columns in each tile.
+     * @throw Throws out_of_range if numRows or numCols is negative, or if tileSize is not positive.
+     * @throw Throws runtime_error if the file cannot be created or mapped, or would be larger than a
+     *        file offset can address.
+     */
+    MappedMatrix(std::string const& path, int numRows, int numCols, int tileSize = defaultTileSize);
+
+    /**
+     * @brief A constructor which creates, or overwrites, the specified file with a copy of the
+     *        specified matrix.
+     *
+     * @param path Path of the file.
+     * @param sm SmallMatrix to copy.
+     * @param tileSize Number of rows and columns in each tile.
+     * @throw Throws out_of_range if tileSize is not positive.
+     * @throw Throws runtime_error if the file cannot be created or mapped, or would be larger than a
+     *        file offset can address.
+     */
+    MappedMatrix(std::string const& path, SmallMatrix const& sm, int tileSize = defaultTileSize);
+
+    /**
+     * @brief A constructor which maps a matrix file written by an earlier MappedMatrix.
+     *
+     * @param path Path of the file.
+     * @param writable If false, the file is mapped read-only and cannot be changed.
+     * @throw Throws runtime_error if the file cannot be opened or mapped, or is not a matrix file.
+     */
+    explicit MappedMatrix(std::string const& path, bool writable = true);
+
+    MappedMatrix(MappedMatrix const&) = delete;
+    MappedMatrix& operator=(MappedMatrix const&) = delete;
+
+    /**
+     * @brief Move constructor. The moved-from matrix no longer maps any file.
+     *
+     * @param other MappedMatrix to move from.
+     */
+    MappedMatrix(MappedMatrix&& other) noexcept;
+
+    /**
+     * @brief Move assignment. The file mapped by this matrix is unmapped first.
+     *
+     * @param other MappedMatrix to move from.
+     * @return MappedMatrix&
+     */
+    MappedMatrix& operator=(MappedMatrix&& other) noexcept;
+
+    /**
+     * @brief Destructor. Unmaps and closes the file. Changes are kept in the file.
+     */
+    ~MappedMatrix();
+
+    /**
+     * @brief Returns a SmallMatrix holding the same elements. The whole matrix is read into memory.
+     *
+     * @return SmallMatrix
+     */
+    SmallMatrix toSmallMatrix() const;
+
+    /**
+     * @brief Returns the reference of the matrix element at the specified row and column index.
+     *
+     * @param numRow Row index.
+     * @param numCol Column index.
+     * @return double&
+     * @throw Throws out_of_range if the specified row and column is outside the range [0, max_row)
+     *        and [0, max_col) respectively.
+     * @throw Throws runtime_error if the file is mapped read-only.
+     */
+    double& operator()(int numRow, int numCol);
+
+    /**
+     * @brief Returns the constant reference of the matrix element at the specified row and column
+     *        index.
+     *
+     * @param numRow Row index.
+     * @param numCol Column index.
+     * @return const double&
+     * @throw Throws out_of_range if the specified row and column is outside the range [0, max_row)
+     *        and [0, max_col) respectively.
+     */
+    const double& operator()(int numRow, int numCol) const;
+
+    /**
+     * @brief Returns the size of the matrix where the first of the pair is the number of rows and
+     *        the second of the pair is the number of columns.
+     *
+     * @return std::pair<int, int>
+     */
+    std::pair<int, int> size() const;
+
+    /**
+     * @brief Returns the number of rows and columns in each tile.
+     *
+     * @return int
+     */
+    int tileSize() const;
+
+    /**
+     * @brief Returns the path of the mapped file.
+     *
+     * @return std::string const&
+     */
+    std::string const& path() const;
+
+    /**
+     * @brief Blocks until every change to the matrix has been written to the file.
+     *
+     * @throw Throws runtime_error if the changes cannot be written.
+     */
+    void flush() const;
+
+    /**
+     * @brief Writes the matrix multiplication of the two specified matrices to the specified file
+     *        and returns it, holding at most five tiles in memory. Each output tile is accumulated
+     *        from pairs of operand tiles with the in-memory multiply kernel, while the next pair is
+     *        read from the operand files on the library's executor. Finished output tiles are
+     *        handed back to the file, and operand tiles are released once used. The result is
+     *        identical to multiplying the matrices in memory.
+     *
+     * @param lhs Left-hand side matrix.
+     * @param rhs Right-hand side matrix.
+     * @param path Path of the file for the result, which uses the tile size of the operands.
+     * @return MappedMatrix
+     * @throw Throws invalid_argument if the number of columns on the left-hand side is not equal to
+     *        the number of rows on the right-hand side, if the operands have different tile sizes,
+     *        or if path names the file of an operand.
+     * @throw Throws runtime_error if the file for the result cannot be created or mapped.
+     */
+    friend MappedMatrix multiply(MappedMatrix const& lhs, MappedMatrix const& rhs, std::string const& path);
+
+    static constexpr int defaultTileSize = 256;
+
+private:
+    /**
+     * @brief Maps the first mMappingSize bytes of the open file.
+     *
+     * @throw Throws runtime_error if the file cannot be mapped.
+     */
+    void map();
+
+    /**
+     * @brief Unmaps and closes the file, if any.
+     */
+    void release() noexcept;
+
+    /**
+     * @brief Returns a pointer to the first element of the specified tile.
+     *
+     * @param tileRow Row index of the tile.
+     * @param tileCol Column index of the tile.
+     * @return double*
+     */
+    double* tileData(int tileRow, int tileCol);
+
+    /**
+     * @brief Returns a pointer to the first element of constant type of the specified tile.
+     *
+     * @param tileRow Row index of the tile.
+     * @param tileCol Column index of the tile.
+     * @return double const*
+     */
+    double const* tileData(int tileRow, int tileCol) const;
+
+    /**
+     * @brief Returns the specified tile as a SmallMatrix, without the zero padding of edge tiles.
+     *
+     * @param tileRow Row index of the tile.
+     * @param tileCol Column index of the tile.
+     * @return SmallMatrix
+     */
+    SmallMatrix readTile(int tileRow, int tileCol) const;
+
+    /**
+     * @brief Copies the specified matrix into the specified tile, starting writeback of the tile
+     *        and releasing its pages from memory.
+     *
+     * @param tileRow Row index of the tile.
+     * @param tileCol Column index of the tile.
+     * @param tile Matrix with the dimensions of the tile without padding.
+     */
+    void writeTile(int tileRow, int tileCol, SmallMatrix const& tile);
+
+    /**
+     * @brief Passes the specified advice about the pages of the specified tile to the kernel.
+     *
+     * @param tileRow Row index of the tile.
+     * @param tileCol Column index of the tile.
+     * @param advice An madvise advice, such as MADV_WILLNEED or MADV_DONTNEED.
+     */
+    void adviseTile(int tileRow, int tileCol, int advice) const;
+
+    std::string mPath;
+    int mFile;
+    bool mIsWritable;
+    int mNumRows;
+    int mNumCols;
+    int mTileSize;
+    int mNumTileRows;
+    int mNumTileCols;
+    std::size_t mMappingSize;
+    double* mData;
+    void* mMapping;
+};
+
+// Forward declaring.
+MappedMatrix multiply(MappedMatrix const&, MappedMatrix const&, std::string const&);
+
+}  // namespace smallMatrix
@@ -0,0 +1,105 @@
+/*
+Asynchronous matrix operations for the Small Matrix program.
+*/
+
+#include "MatrixFuture.hpp"
+#include "Executor.hpp"
+#include <algorithm>
+#include <atomic>
+namespace smallMatrix {
+
+MatrixFuture::MatrixFuture()
+    :   mState {std::make_shared<State>()} {}
+
+MatrixFuture::MatrixFuture(SmallMatrix sm)
+    :   mState {std::make_shared<State>()} {
+    mState->value = std::move(sm);
+    mState->ready = true;
+}
+
+SmallMatrix const& MatrixFuture::get() const {
+    wait();
+    if (mState->error) {
+        std::rethrow_exception(mState->error);
+    }
+    return mState->value;
+}
+
+void MatrixFuture::wait() const {
+    std::unique_lock<std::mutex> lock(mState->mutex);
+    mState->readyChanged.wait(lock, [this]() { return mState->ready; });
+}
+
+bool MatrixFuture::isReady() const {
+    std::lock_guard<std::mutex> lock(mState->mutex);
+    return mState->ready;
+}
+
+void MatrixFuture::fulfil(std::function<SmallMatrix()> const& compute) const {
+    SmallMatrix value;
+    std::exception_ptr error;
+    try {
+        value = compute();
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    std::vector<std::function<void()>> continuations;
+    {
+        std::lock_guard<std::mutex> lock(mState->mutex);
+        mState->value = std::move(value);
+        mState->error = error;
+        mState->ready = true;
+        continuations.swap(mState->continuations);
+    }
+    mState->readyChanged.notify_all();
+    std::for_each(continuations.begin(), continuations.end(), [](auto& continuation) { continuation(); });
+}
+
+void MatrixFuture::onReady(std::function<void()> continuation) const {
+    {
+        std::lock_guard<std::mutex> lock(mState->mutex);
+        if (!mState->ready) {
+            mState->continuations.push_back(std::move(continuation));
+            return;
+        }
+    }
+    continuation();
+}
+
+MatrixFuture computeAsync(std::vector<MatrixFuture> const& dependencies,
+                          std::function<SmallMatrix()> compute) {
+    MatrixFuture result;
+    auto schedule = [result, compute]() {
+        Executor::instance().submit([result, compute]() { result.fulfil(compute); });
+    };
+    if (dependencies.empty()) {
+        schedule();
+        return result;
+    }
+
+    // The last dependency to become ready queues the computation
+    auto remaining = std::make_shared<std::atomic<int>>(dependencies.size());
+    for (auto const& dependency : dependencies) {
+        dependency.onReady([remaining, schedule]() {
+            if (--(*remaining) == 0) {
+                schedule();
+            }
+        });
+    }
+    return result;
+}
+
+MatrixFuture multiplyAsync(MatrixFuture const& lhs, MatrixFuture const& rhs) {
+    return computeAsync({lhs, rhs}, [lhs, rhs]() { return lhs.get() * rhs.get(); });
+}
+
+MatrixFuture solveAsync(MatrixFuture const& lhs, MatrixFuture const& rhs) {
+    return computeAsync({lhs, rhs}, [lhs, rhs]() { return solve(lhs.get(), rhs.get()); });
+}
+
+MatrixFuture transposeAsync(MatrixFuture const& sm) {
+    return computeAsync({sm}, [sm]() { return transpose(sm.get()); });
+}
+
+}  // namespace smallMatrix
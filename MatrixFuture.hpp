@@ -0,0 +1,128 @@
+/**
+ * @file MatrixFuture.hpp
+ * @author Mohamad Baydoun
+ * @brief Header file for MatrixFuture.cpp
+ */
+#pragma once
+
+#include "SmallMatrix.hpp"
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace smallMatrix {
+
+class MatrixFuture {
+public:
+    /**
+     * @brief A constructor which initialises a future that is already ready with the given matrix,
+     *        so that plain matrices can be passed wherever a future is expected.
+     *
+     * @param sm Value of the future.
+     */
+    MatrixFuture(SmallMatrix sm);
+
+    /**
+     * @brief Blocks until the future is ready, then returns the constant reference of its value.
+     *        The reference is valid for as long as any copy of the future exists.
+     *
+     * @return SmallMatrix const&
+     * @throw Rethrows the exception thrown by the operation that produces the value.
+     */
+    SmallMatrix const& get() const;
+
+    /**
+     * @brief Blocks until the future is ready.
+     */
+    void wait() const;
+
+    /**
+     * @brief Returns true if the value of the future, or the exception that replaced it, is
+     *        available.
+     *
+     * @return true, if get() will not block.
+     * @return false, otherwise.
+     */
+    bool isReady() const;
+
+    /**
+     * @brief Returns a future for the result of the specified function, which is run on the
+     *        library's executor once every dependency is ready. No thread blocks while waiting for
+     *        the dependencies, so dependent operations can be chained into a graph of any depth.
+     *        If a dependency fails, its exception is propagated when the function calls get().
+     *
+     * @param dependencies Futures that must be ready before the function runs.
+     * @param compute Function producing the value of the returned future.
+     * @return MatrixFuture
+     */
+    friend MatrixFuture computeAsync(std::vector<MatrixFuture> const& dependencies,
+                                     std::function<SmallMatrix()> compute);
+
+private:
+    struct State {
+        std::mutex mutex;
+        std::condition_variable readyChanged;
+        bool ready {false};
+        SmallMatrix value;
+        std::exception_ptr error;
+        std::vector<std::function<void()>> continuations;
+    };
+
+    /**
+     * @brief A constructor which initialises a future that is not ready yet.
+     */
+    MatrixFuture();
+
+    /**
+     * @brief Makes the future ready with the result of the specified function, or with the
+     *        exception it throws, then runs the continuations waiting on it.
+     *
+     * @param compute Function producing the value of the future.
+     */
+    void fulfil(std::function<SmallMatrix()> const& compute) const;
+
+    /**
+     * @brief Calls the specified function once the future is ready. It is called immediately on
+     *        the calling thread if the future is already ready.
+     *
+     * @param continuation Function to call.
+     */
+    void onReady(std::function<void()> continuation) const;
+
+    std::shared_ptr<State> mState;
+};
+
+/**
+ * @brief Returns a future for the matrix multiplication of the two specified matrices.
+ *
+ * @param lhs Left-hand side matrix.
+ * @param rhs Right-hand side matrix.
+ * @return MatrixFuture
+ */
+MatrixFuture multiplyAsync(MatrixFuture const& lhs, MatrixFuture const& rhs);
+
+/**
+ * @brief Returns a future for the solution X of the linear system lhs * X = rhs.
+ *
+ * @param lhs Square coefficient matrix.
+ * @param rhs Right-hand side matrix.
+ * @return MatrixFuture
+ */
+MatrixFuture solveAsync(MatrixFuture const& lhs, MatrixFuture const& rhs);
+
+/**
+ * @brief Returns a future for the transpose of the specified matrix.
+ *
+ * @param sm Matrix to be transposed.
+ * @return MatrixFuture
+ */
+MatrixFuture transposeAsync(MatrixFuture const& sm);
+
+// Forward declaring.
+MatrixFuture computeAsync(std::vector<MatrixFuture> const&, std::function<SmallMatrix()>);
+
+}  // namespace smallMatrix
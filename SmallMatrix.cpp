@@ -3,8 +3,18 @@ Small Matrix program by Mohamad Baydoun.
 */
 
 #include "SmallMatrix.hpp"
+#include "Executor.hpp"
 #include <cstdlib>
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <exception>
+#include <initializer_list>
+#include <limits>
+#include <mutex>
+#include <type_traits>
+#include <utility>
 namespace smallMatrix {
 
 template<std::size_t arraySize>
@@ -49,14 +59,190 @@ const std::vector<std::vector<double>> convertStdArrayToStdVector(const std::arr
 }
 
 
+// Sums a contiguous range of transformed elements pairwise, so the rounding error grows with
+// O(log n) instead of O(n). The base case keeps four independent accumulators so the loop can be
+// vectorised.
+template<typename Transform>
+double pairwiseSum(double const* data, int count, Transform transform) {
+    if (count <= 64) {
+        double accumulators[4] {};
+        int i {};
+        for (; i + 4 <= count; i += 4) {
+            accumulators[0] += transform(data[i]);
+            accumulators[1] += transform(data[i + 1]);
+            accumulators[2] += transform(data[i + 2]);
+            accumulators[3] += transform(data[i + 3]);
+        }
+        for (; i < count; i++) {
+            accumulators[0] += transform(data[i]);
+        }
+        return (accumulators[0] + accumulators[1]) + (accumulators[2] + accumulators[3]);
+    }
+    const int half = count / 2;
+    return pairwiseSum(data, half, transform) + pairwiseSum(data + half, count - half, transform);
+}
+
+
+// Returns the dot product of two contiguous ranges, with four independent accumulators so the
+// loop can be vectorised
+inline double dotProduct(double const* lhs, double const* rhs, int count) {
+    double accumulators[4] {};
+    int i {};
+    for (; i + 4 <= count; i += 4) {
+        accumulators[0] += lhs[i] * rhs[i];
+        accumulators[1] += lhs[i + 1] * rhs[i + 1];
+        accumulators[2] += lhs[i + 2] * rhs[i + 2];
+        accumulators[3] += lhs[i + 3] * rhs[i + 3];
+    }
+    for (; i < count; i++) {
+        accumulators[0] += lhs[i] * rhs[i];
+    }
+    return (accumulators[0] + accumulators[1]) + (accumulators[2] + accumulators[3]);
+}
+
+
+// Neumaier's variant of Kahan summation, used to combine row and chunk partial sums
+struct CompensatedSum {
+    double sum {};
+    double compensation {};
+
+    void add(double value) {
+        const double total = sum + value;
+        if (std::abs(sum) >= std::abs(value)) {
+            compensation += (sum - total) + value;
+        } else {
+            compensation += (value - total) + sum;
+        }
+        sum = total;
+    }
+
+    double result() const { return sum + compensation; }
+};
+
+
 // Returns the number of elements of the matrix
 const int getNumberOfElements(SmallMatrix const& sm) {
     return sm.size().first * sm.size().second;
 }
 
+// Returns true if an operation doing the specified amount of work should be split across threads
+// under the specified execution policy
+bool isParallelWork(ExecutionPolicy policy, long long work, long long parallelThreshold) {
+    return policy == ExecutionPolicy::ThreadPool || (policy == ExecutionPolicy::Parallel && work >= parallelThreshold);
+}
+
+
+// Range of dimensions for which operations use the unrolled kernels below instead of the generic
+// loops. The kernels work on the stack array, so callers must also check that every matrix they
+// touch isSmall(): a large matrix shrunk to one of these shapes keeps its heap storage.
+constexpr int minUnrolledSize = 2;
+constexpr int maxUnrolledSize = 8;
+constexpr int numUnrolledSizes = maxUnrolledSize - minUnrolledSize + 1;
+
+// Returns true if an unrolled kernel exists for every one of the specified dimensions
+bool isUnrolledShape(std::initializer_list<int> dimensions) {
+    return std::all_of(dimensions.begin(), dimensions.end(), [](int n) { return n >= minUnrolledSize && n <= maxUnrolledSize; });
+}
+
+// Calls f(std::integral_constant<int, i>()) for every i in [0, count), written out one call after
+// another, so every index in the body of f is a compile-time constant
+template<typename Function, int... indices>
+void unroll(Function const& f, std::integer_sequence<int, indices...>) {
+    const int calls[] {0, (f(std::integral_constant<int, indices>()), 0)...};
+    static_cast<void>(calls);
+}
+
+template<int count, typename Function>
+void unroll(Function const& f) {
+    unroll(f, std::make_integer_sequence<int, count>());
+}
+
+template<std::size_t arraySize>
+using StackArray = std::array<std::array<double, arraySize>, arraySize>;
+
+// Fully unrolled kernels for matrices whose dimensions are known at compile time. The multiply
+// kernel is specialised on the inner dimension and the number of columns, and loops over the rows
+// of the result, since every row is computed by the same code. Each row is accumulated in a local
+// array that the compiler can keep in vector registers, adding the products for each element in
+// the same order as the generic kernel, so both give identical results.
+template<std::size_t arraySize, int inner, int cols>
+void multiplyUnrolled(StackArray<arraySize> const& lhs, StackArray<arraySize> const& rhs, StackArray<arraySize>& out, int rows) {
+    for (int i {}; i < rows; i++) {
+        double row[cols] {};
+        unroll<inner>([&](auto k) {
+            const double scalar = lhs[i][k];
+            unroll<cols>([&](auto j) { row[j] += scalar * rhs[k][j]; });
+        });
+        unroll<cols>([&](auto j) { out[i][j] = row[j]; });
+    }
+}
+
+template<std::size_t arraySize, int rows, int cols>
+void addUnrolled(StackArray<arraySize> const& lhs, StackArray<arraySize> const& rhs, StackArray<arraySize>& out) {
+    unroll<rows>([&](auto i) {
+        unroll<cols>([&](auto j) { out[i][j] = lhs[i][j] + rhs[i][j]; });
+    });
+}
+
+template<std::size_t arraySize, int rows, int cols>
+void transposeUnrolled(StackArray<arraySize> const& in, StackArray<arraySize>& out) {
+    unroll<rows>([&](auto i) {
+        unroll<cols>([&](auto j) { out[j][i] = in[i][j]; });
+    });
+}
+
+// Compares every element without branching, which is cheaper than stopping early at these sizes
+template<std::size_t arraySize, int rows, int cols>
+bool equalsUnrolled(StackArray<arraySize> const& lhs, StackArray<arraySize> const& rhs, double epsilon) {
+    bool isEqual {true};
+    unroll<rows>([&](auto i) {
+        unroll<cols>([&](auto j) { isEqual &= !(std::abs(lhs[i][j] - rhs[i][j]) > epsilon); });
+    });
+    return isEqual;
+}
+
+// Dispatch tables holding one kernel per shape. Multiply kernels are indexed by (inner, cols),
+// the others by (rows, cols), each offset by minUnrolledSize.
+template<std::size_t arraySize>
+using MultiplyKernelFunction = void (*)(StackArray<arraySize> const&, StackArray<arraySize> const&, StackArray<arraySize>&, int);
+
+template<std::size_t arraySize>
+using BinaryKernelFunction = void (*)(StackArray<arraySize> const&, StackArray<arraySize> const&, StackArray<arraySize>&);
+
+template<std::size_t arraySize>
+using TransposeKernelFunction = void (*)(StackArray<arraySize> const&, StackArray<arraySize>&);
+
+template<std::size_t arraySize>
+using EqualsKernelFunction = bool (*)(StackArray<arraySize> const&, StackArray<arraySize> const&, double);
+
+template<std::size_t arraySize, std::size_t... shapes>
+constexpr std::array<MultiplyKernelFunction<arraySize>, sizeof...(shapes)> makeMultiplyKernels(std::index_sequence<shapes...>) {
+    return {{&multiplyUnrolled<arraySize, minUnrolledSize + shapes / numUnrolledSizes, minUnrolledSize + shapes % numUnrolledSizes>...}};
+}
+
+template<std::size_t arraySize, std::size_t... shapes>
+constexpr std::array<BinaryKernelFunction<arraySize>, sizeof...(shapes)> makeAddKernels(std::index_sequence<shapes...>) {
+    return {{&addUnrolled<arraySize, minUnrolledSize + shapes / numUnrolledSizes, minUnrolledSize + shapes % numUnrolledSizes>...}};
+}
+
+template<std::size_t arraySize, std::size_t... shapes>
+constexpr std::array<TransposeKernelFunction<arraySize>, sizeof...(shapes)> makeTransposeKernels(std::index_sequence<shapes...>) {
+    return {{&transposeUnrolled<arraySize, minUnrolledSize + shapes / numUnrolledSizes, minUnrolledSize + shapes % numUnrolledSizes>...}};
+}
+
+template<std::size_t arraySize, std::size_t... shapes>
+constexpr std::array<EqualsKernelFunction<arraySize>, sizeof...(shapes)> makeEqualsKernels(std::index_sequence<shapes...>) {
+    return {{&equalsUnrolled<arraySize, minUnrolledSize + shapes / numUnrolledSizes, minUnrolledSize + shapes % numUnrolledSizes>...}};
+}
+
+// Returns the index in a dispatch table of the kernel for the specified pair of dimensions
+int unrolledKernelIndex(int first, int second) {
+    return (first - minUnrolledSize) * numUnrolledSizes + second - minUnrolledSize;
+}
+
 
 SmallMatrix::SmallMatrix()
-: mNumRows {0}, mNumCols {0} {};
+: mNumRows {0}, mNumCols {0}, mIsLargeMatrix {false} {};
 
 SmallMatrix::SmallMatrix(int numRows, int numCols) 
     :   mNumRows {numRows}, 
@@ -67,7 +253,7 @@ SmallMatrix::SmallMatrix(int numRows, int numCols)
     if (mIsLargeMatrix) {
        mHeapData = std::vector<std::vector<double>> (numRows, std::vector<double>(numCols));
     } else {
-        SmallMatrix(numRows, numCols, 0);
+        std::for_each(mStackData.begin(), mStackData.begin() + numRows, [&](auto& row){std::fill(row.begin(), row.begin() + numCols, 0.0);});
     }
 }
 
@@ -115,20 +301,42 @@ SmallMatrix::SmallMatrix(std::initializer_list<std::initializer_list<double>> co
     }
 }
 
+SmallMatrix::SmallMatrix(ConstBlock const& block)
+    :   SmallMatrix(block.mNumRows, block.mNumCols) {
+    for (int i {}; i < mNumRows; i++) {
+        std::copy(block.rowData(i), block.rowData(i) + mNumCols, rowData(i));
+    }
+}
+
 SmallMatrix::SmallMatrix(SmallMatrix const& sm) 
+    :   SmallMatrix(sm, ExecutionPolicy::Parallel) {}
+
+SmallMatrix::SmallMatrix(SmallMatrix const& sm, ExecutionPolicy policy)
     :   mNumRows {sm.mNumRows},
         mNumCols {sm.mNumCols},
         mIsLargeMatrix(mNumRows * mNumCols >= mSmallSize) {
-    // Copy the elements of the other matrix into the current one, depending on the n.o of elements
+    // Copy the elements of the other matrix into the current one, depending on the n.o of elements.
+    // Copy-on-write matrices share the heap buffer instead of copying it
     if (mIsLargeMatrix) {
-        mHeapData = sm.mHeapData;
+        if (!sm.mSharedHeapData) {
+            // Each row is allocated and filled by the thread that copies it
+            mHeapData.resize(mNumRows);
+            forEachRowChunk([&](int firstRow, int lastRow) {
+                for (int i {firstRow}; i < lastRow; i++) {
+                    mHeapData[i].assign(sm.mHeapData[i].cbegin(), sm.mHeapData[i].cend());
+                }
+            }, policy, Tuner::parameters().copyParallelThreshold);
+        }
     } else {
        for (int i {}; i < mNumRows; i++) {
-            for (int j {}; j < mNumCols; j++) {
-                (*this)(i, j) = sm(i, j);
-            }
+            std::copy(sm.rowData(i), sm.rowData(i) + mNumCols, rowData(i));
         }
     }
+    // A small copy of a shrunk large matrix holds its elements on the stack, so it must not keep
+    // the buffer shared
+    if (mIsLargeMatrix) {
+        mSharedHeapData = sm.mSharedHeapData;
+    }
 }
 
 SmallMatrix::SmallMatrix(SmallMatrix&& sm)
@@ -141,16 +349,33 @@ SmallMatrix::SmallMatrix(SmallMatrix&& sm)
     } else {
         mStackData = std::exchange(sm.mStackData, {{}});
     }
+    mSharedHeapData = std::move(sm.mSharedHeapData);
 }
 
 SmallMatrix& SmallMatrix::operator=(SmallMatrix const& sm) {
+    return assign(sm, ExecutionPolicy::Parallel);
+}
+
+SmallMatrix& SmallMatrix::assign(SmallMatrix const& sm, ExecutionPolicy policy) {
     if (this != &sm) {
         mNumRows = sm.mNumRows;
         mNumCols = sm.mNumCols;
         mIsLargeMatrix  = getNumberOfElements(sm) >= mSmallSize ? true : false;
         if (mIsLargeMatrix) {
-            mHeapData = sm.mHeapData;
+            mSharedHeapData = sm.mSharedHeapData;
+            if (!mSharedHeapData) {
+                // Each row is reallocated, if needed, and filled by the thread that copies it
+                mHeapData.resize(mNumRows);
+                forEachRowChunk([&](int firstRow, int lastRow) {
+                    for (int i {firstRow}; i < lastRow; i++) {
+                        mHeapData[i].assign(sm.mHeapData[i].cbegin(), sm.mHeapData[i].cend());
+                    }
+                }, policy, Tuner::parameters().copyParallelThreshold);
+            } else {
+                mHeapData.clear();
+            }
         } else {
+            mSharedHeapData.reset();
             for (int i {}; i < mNumRows; i++) {
                 for (int j {}; j < mNumCols; j++) {
                     (*this)(i, j) = sm(i, j);
@@ -171,13 +396,92 @@ SmallMatrix& SmallMatrix::operator=(SmallMatrix&& sm) {
         } else {
             mStackData = std::exchange(sm.mStackData, {{}});
         }
+        mSharedHeapData = std::move(sm.mSharedHeapData);
     }
     return *this;
 }
 
 SmallMatrix::~SmallMatrix() {}
 
+double* SmallMatrix::rowData(int numRow) {
+    return mIsLargeMatrix ? mutableHeapData()[numRow].data() : mStackData[numRow].data();
+}
+
+double const* SmallMatrix::rowData(int numRow) const {
+    return mIsLargeMatrix ? heapData()[numRow].data() : mStackData[numRow].data();
+}
+
+std::vector<std::vector<double>> const& SmallMatrix::heapData() const {
+    return mSharedHeapData ? *mSharedHeapData : mHeapData;
+}
+
+std::vector<std::vector<double>>& SmallMatrix::mutableHeapData() {
+    if (!mSharedHeapData) {
+        return mHeapData;
+    }
+    // Detach from the other copies before the buffer is modified
+    if (!mSharedHeapData.isUnique()) {
+        mSharedHeapData = SharedHeapData(*mSharedHeapData);
+    }
+    return *mSharedHeapData;
+}
+
+void SmallMatrix::setCopyOnWrite(bool enabled) {
+    // Small matrices are always copied by value
+    if (enabled && !mSharedHeapData && mIsLargeMatrix) {
+        mSharedHeapData = SharedHeapData(std::move(mHeapData));
+        mHeapData.clear();
+    } else if (!enabled && mSharedHeapData) {
+        mHeapData = mSharedHeapData.isUnique() ? std::move(*mSharedHeapData) : *mSharedHeapData;
+        mSharedHeapData.reset();
+    }
+}
+
+bool SmallMatrix::isCopyOnWrite() const { return static_cast<bool>(mSharedHeapData); }
+
+SmallMatrix::SharedHeapData::SharedHeapData(std::vector<std::vector<double>> rows)
+    :   mBuffer {new Buffer {std::move(rows)}} {}
+
+SmallMatrix::SharedHeapData::SharedHeapData(SharedHeapData const& other) noexcept
+    :   mBuffer {other.mBuffer} {
+    if (mBuffer != nullptr) {
+        mBuffer->numOwners.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+SmallMatrix::SharedHeapData::SharedHeapData(SharedHeapData&& other) noexcept
+    :   mBuffer {std::exchange(other.mBuffer, nullptr)} {}
+
+SmallMatrix::SharedHeapData& SmallMatrix::SharedHeapData::operator=(SharedHeapData other) noexcept {
+    std::swap(mBuffer, other.mBuffer);
+    return *this;
+}
+
+SmallMatrix::SharedHeapData::~SharedHeapData() {
+    reset();
+}
+
+SmallMatrix::SharedHeapData::operator bool() const { return mBuffer != nullptr; }
+
+std::vector<std::vector<double>>& SmallMatrix::SharedHeapData::operator*() const { return mBuffer->rows; }
+
+bool SmallMatrix::SharedHeapData::isUnique() const {
+    // Pairs with the release in reset(), so the reads of every former owner happen before the
+    // caller writes to the buffer
+    return mBuffer->numOwners.load(std::memory_order_acquire) == 1;
+}
+
+void SmallMatrix::SharedHeapData::reset() {
+    if (mBuffer != nullptr && mBuffer->numOwners.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        delete mBuffer;
+    }
+    mBuffer = nullptr;
+}
+
 double& SmallMatrix::operator()(int numRow, int numCol) {
+    if (mIsLargeMatrix) {
+        mutableHeapData();
+    }
     // https://stackoverflow.com/questions/856542/elegant-solution-to-duplicate-const-and-non-const-getters
     return const_cast<double&>(const_cast<const SmallMatrix*>(this)->operator()(numRow, numCol));
 }
@@ -188,7 +492,7 @@ const double& SmallMatrix::operator()(int numRow, int numCol) const {
     if (outOfRange) {
         throw std::out_of_range("Out Of Range!");
     } else { 
-        return mIsLargeMatrix ? mHeapData.at(numRow).at(numCol) : mStackData.at(numRow).at(numCol);
+        return mIsLargeMatrix ? heapData().at(numRow).at(numCol) : mStackData.at(numRow).at(numCol);
     }
 
 }
@@ -200,7 +504,8 @@ std::vector<double*> SmallMatrix::row(int numRow) {
 
     std::vector<double*> cols;
     if (mIsLargeMatrix) {
-        std::for_each(mHeapData.at(numRow).begin(), mHeapData.at(numRow).end(), [&](auto& col){cols.push_back(&col);});
+        auto& heapRow = mutableHeapData().at(numRow);
+        std::for_each(heapRow.begin(), heapRow.end(), [&](auto& col){cols.push_back(&col);});
     } else {
         std::for_each(mStackData.at(numRow).begin(), mStackData.at(numRow).begin() + mNumCols, [&](auto& col){cols.push_back(&col);});
     }
@@ -214,7 +519,7 @@ std::vector<double const*> SmallMatrix::row(int numRow) const {
     }
     std::vector<double const*> cols;
     if (mIsLargeMatrix) {
-        std::for_each(mHeapData.at(numRow).cbegin(), mHeapData.at(numRow).cend(), [&](auto const& col){cols.push_back(&col);});
+        std::for_each(heapData().at(numRow).cbegin(), heapData().at(numRow).cend(), [&](auto const& col){cols.push_back(&col);});
     } else {
         std::for_each(mStackData.at(numRow).cbegin(), mStackData.at(numRow).cbegin() + mNumCols, [&](auto const& col){cols.push_back(&col);});
     }
@@ -228,7 +533,8 @@ std::vector<double*> SmallMatrix::col(int numCol) {
     
     std::vector<double*> rows;
     if (mIsLargeMatrix) {
-        std::for_each(mHeapData.begin(), mHeapData.end(), [&](auto& row){rows.push_back(&row.at(numCol));});
+        auto& heapData = mutableHeapData();
+        std::for_each(heapData.begin(), heapData.end(), [&](auto& row){rows.push_back(&row.at(numCol));});
     } else {
         std::for_each(mStackData.begin(), mStackData.begin() + mNumCols, [&](auto& row){rows.push_back(&row.at(numCol));});
     }
@@ -242,7 +548,7 @@ std::vector<double const*> SmallMatrix::col(int numCol) const {
 
     std::vector<double const*> rows;
     if (mIsLargeMatrix) {
-        std::for_each(mHeapData.cbegin(), mHeapData.cend(), [&](auto const& row){rows.push_back(&row.at(numCol));});
+        std::for_each(heapData().cbegin(), heapData().cend(), [&](auto const& row){rows.push_back(&row.at(numCol));});
     } else {
         std::for_each(mStackData.cbegin(), mStackData.cbegin() + mNumRows, [&](auto const& row){rows.push_back(&row.at(numCol));});
     }
@@ -254,7 +560,145 @@ std::pair<int, int> SmallMatrix::size() const { return {std::make_pair(mNumRows,
 
 bool SmallMatrix::isSmall() const { return !mIsLargeMatrix ? true : false; }
 
+SmallMatrix::Block SmallMatrix::block(int numRow, int numCol, int numRows, int numCols) {
+    const bool outOfRange = (numRow < 0 || numCol < 0 || numRows < 0 || numCols < 0
+        || numRow + numRows > mNumRows || numCol + numCols > mNumCols) ? true : false;
+    if (outOfRange) {
+        throw std::out_of_range("Out of Range! Illegal block access");
+    }
+    return Block(this, numRow, numCol, numRows, numCols);
+}
+
+SmallMatrix::ConstBlock SmallMatrix::block(int numRow, int numCol, int numRows, int numCols) const {
+    const bool outOfRange = (numRow < 0 || numCol < 0 || numRows < 0 || numCols < 0
+        || numRow + numRows > mNumRows || numCol + numCols > mNumCols) ? true : false;
+    if (outOfRange) {
+        throw std::out_of_range("Out of Range! Illegal block access");
+    }
+    return ConstBlock(this, numRow, numCol, numRows, numCols);
+}
+
+SmallMatrix::ConstBlock::ConstBlock(SmallMatrix const& sm)
+    :   ConstBlock(&sm, 0, 0, sm.mNumRows, sm.mNumCols) {}
+
+SmallMatrix::ConstBlock::ConstBlock(SmallMatrix const* sm, int firstRow, int firstCol, int numRows, int numCols)
+    :   mMatrix {sm},
+        mFirstRow {firstRow},
+        mFirstCol {firstCol},
+        mNumRows {numRows},
+        mNumCols {numCols} {}
+
+const double& SmallMatrix::ConstBlock::operator()(int numRow, int numCol) const {
+    if (numRow >= mNumRows || numCol >= mNumCols || numRow < 0 || numCol < 0) {
+        throw std::out_of_range("Out Of Range!");
+    }
+    return rowData(numRow)[numCol];
+}
+
+std::pair<int, int> SmallMatrix::ConstBlock::size() const { return {std::make_pair(mNumRows, mNumCols)}; }
+
+double const* SmallMatrix::ConstBlock::rowData(int numRow) const {
+    return mMatrix->rowData(mFirstRow + numRow) + mFirstCol;
+}
+
+bool SmallMatrix::ConstBlock::overlaps(ConstBlock const& other) const {
+    return mMatrix == other.mMatrix
+        && mFirstRow < other.mFirstRow + other.mNumRows && other.mFirstRow < mFirstRow + mNumRows
+        && mFirstCol < other.mFirstCol + other.mNumCols && other.mFirstCol < mFirstCol + mNumCols;
+}
+
+SmallMatrix::Block::Block(SmallMatrix* sm, int firstRow, int firstCol, int numRows, int numCols)
+    :   mMatrix {sm},
+        mFirstRow {firstRow},
+        mFirstCol {firstCol},
+        mNumRows {numRows},
+        mNumCols {numCols} {}
+
+SmallMatrix::Block::operator ConstBlock() const {
+    return ConstBlock(mMatrix, mFirstRow, mFirstCol, mNumRows, mNumCols);
+}
+
+SmallMatrix::Block const& SmallMatrix::Block::operator=(ConstBlock const& other) const {
+    if (mNumRows != other.mNumRows || mNumCols != other.mNumCols) {
+        throw std::invalid_argument("Unequal dimensions!");
+    }
+
+    // Overlapping blocks go through a copy, so no element is overwritten before it is read
+    if (other.overlaps(*this)) {
+        return *this = ConstBlock(SmallMatrix(other));
+    }
+    for (int i {}; i < mNumRows; i++) {
+        std::copy(other.rowData(i), other.rowData(i) + mNumCols, rowData(i));
+    }
+    return *this;
+}
+
+SmallMatrix::Block const& SmallMatrix::Block::operator=(Block const& other) const {
+    return *this = static_cast<ConstBlock>(other);
+}
+
+SmallMatrix::Block const& SmallMatrix::Block::operator+=(ConstBlock const& other) const {
+    if (mNumRows != other.mNumRows || mNumCols != other.mNumCols) {
+        throw std::invalid_argument("Unequal dimensions!");
+    }
+    if (other.overlaps(*this)) {
+        return *this += ConstBlock(SmallMatrix(other));
+    }
+    for (int i {}; i < mNumRows; i++) {
+        double* row = rowData(i);
+        double const* otherRow = other.rowData(i);
+        for (int j {}; j < mNumCols; j++) {
+            row[j] += otherRow[j];
+        }
+    }
+    return *this;
+}
+
+SmallMatrix::Block const& SmallMatrix::Block::operator-=(ConstBlock const& other) const {
+    if (mNumRows != other.mNumRows || mNumCols != other.mNumCols) {
+        throw std::invalid_argument("Unequal dimensions!");
+    }
+    if (other.overlaps(*this)) {
+        return *this -= ConstBlock(SmallMatrix(other));
+    }
+    for (int i {}; i < mNumRows; i++) {
+        double* row = rowData(i);
+        double const* otherRow = other.rowData(i);
+        for (int j {}; j < mNumCols; j++) {
+            row[j] -= otherRow[j];
+        }
+    }
+    return *this;
+}
+
+SmallMatrix::Block const& SmallMatrix::Block::operator*=(double s) const {
+    for (int i {}; i < mNumRows; i++) {
+        double* row = rowData(i);
+        for (int j {}; j < mNumCols; j++) {
+            row[j] *= s;
+        }
+    }
+    return *this;
+}
+
+double& SmallMatrix::Block::operator()(int numRow, int numCol) const {
+    if (numRow >= mNumRows || numCol >= mNumCols || numRow < 0 || numCol < 0) {
+        throw std::out_of_range("Out Of Range!");
+    }
+    return rowData(numRow)[numCol];
+}
+
+std::pair<int, int> SmallMatrix::Block::size() const { return {std::make_pair(mNumRows, mNumCols)}; }
+
+double* SmallMatrix::Block::rowData(int numRow) const {
+    return mMatrix->rowData(mFirstRow + numRow) + mFirstCol;
+}
+
 void SmallMatrix::resize(int numRows, int numCols) {
+    resize(numRows, numCols, ExecutionPolicy::Parallel);
+}
+
+void SmallMatrix::resize(int numRows, int numCols, ExecutionPolicy policy) {
 
     if (numRows < 0 || numCols < 0) {
         throw std::out_of_range("Out of Range! Illegal row or column resize value/s");
@@ -271,19 +715,13 @@ void SmallMatrix::resize(int numRows, int numCols) {
     if (getNumberOfElements(*this) >= mSmallSize) {
         if (isSmall()) {
             mIsLargeMatrix = true;
-            mHeapData = convertStdArrayToStdVector(mStackData, tempRowCount, tempColCount);
-        }
-        mHeapData.resize(numRows);
-        for (auto &row : mHeapData) {
-            row.resize(numCols, 0);
+            mutableHeapData() = convertStdArrayToStdVector(mStackData, tempRowCount, tempColCount);
         }
+        resizeHeapRows(policy);
     } else {
         // Row and Column increase/decrease for small matrix
         if (mIsLargeMatrix) {
-            mHeapData.resize(numRows);
-            for (auto &row : mHeapData) {
-                row.resize(numCols, 0);
-            }
+            resizeHeapRows(policy);
         }
         else {
             if (numRows > tempRowCount) {
@@ -314,12 +752,14 @@ void SmallMatrix::insertRow(int numRow, std::vector<double> const& row) {
 
     mNumRows++;
     if (mIsLargeMatrix) {
-        mHeapData.insert(mHeapData.begin() + numRow, row);
+        auto& heapData = mutableHeapData();
+        heapData.insert(heapData.begin() + numRow, row);
     } else {
         if (getNumberOfElements(*this) >= mSmallSize) {
             mIsLargeMatrix = true;
-            mHeapData = convertStdArrayToStdVector(mStackData, mNumRows, mNumCols);
-            mHeapData.insert(mHeapData.begin() + numRow, row);
+            auto& heapData = mutableHeapData();
+            heapData = convertStdArrayToStdVector(mStackData, mNumRows, mNumCols);
+            heapData.insert(heapData.begin() + numRow, row);
         } else {
             mStackData = std::move(shiftArrayElementsDown(mNumRows, mStackData, numRow, mNumCols));
             for (int i {}; i < mNumCols; i++) {
@@ -344,7 +784,7 @@ void SmallMatrix::insertCol(int numCol, std::vector<double> const& col) {
     newTransposedMatrix.insertRow(numCol, col);
     if (newTransposedMatrix.mIsLargeMatrix) {
         mIsLargeMatrix = true;
-        mHeapData = transpose(newTransposedMatrix).mHeapData;
+        mutableHeapData() = transpose(newTransposedMatrix).heapData();
     } else {
         mStackData = transpose(newTransposedMatrix).mStackData;
     }
@@ -361,7 +801,8 @@ void SmallMatrix::eraseRow(int numRow) {
 
     mNumRows--;
     if (mIsLargeMatrix) {
-        mHeapData.erase(mHeapData.begin() + numRow);
+        auto& heapData = mutableHeapData();
+        heapData.erase(heapData.begin() + numRow);
     } else {
         mStackData = std::move(shiftArrayElementsUp(numRow, mStackData, mNumRows, mNumCols));
     }
@@ -377,7 +818,7 @@ void SmallMatrix::eraseCol(int numCol) {
     SmallMatrix newTransposedMatrix = transpose(*this);
     newTransposedMatrix.eraseRow(numCol);
     if (newTransposedMatrix.mIsLargeMatrix) {
-        mHeapData = transpose(newTransposedMatrix).mHeapData;
+        mutableHeapData() = transpose(newTransposedMatrix).heapData();
     } else {
         mStackData = transpose(newTransposedMatrix).mStackData;
     }
@@ -385,79 +826,140 @@ void SmallMatrix::eraseCol(int numCol) {
 }
 
 bool operator==(SmallMatrix const& lhs, SmallMatrix const& rhs) {
-    if (lhs.size() != rhs.size()) { return false; }
-    const double epsilon = 0.0000001;
-    for (int i {}; i < lhs.mNumRows; i++) {
-        for (int j {}; j < lhs.mNumCols; j++) { 
-            if (std::abs(lhs(i, j) - rhs(i, j)) > epsilon) { return false; }
-        }
-    }
-    return true;
+    return equals(lhs, rhs, ExecutionPolicy::Parallel);
 }
 
 bool operator!=(SmallMatrix const& lhs, SmallMatrix const& rhs) {
     return !operator==(lhs, rhs);
 }
 
+bool equals(SmallMatrix const& lhs, SmallMatrix const& rhs, ExecutionPolicy policy) {
+    if (lhs.size() != rhs.size()) { return false; }
+    const double epsilon = 0.0000001;
+
+    if (isUnrolledShape({lhs.mNumRows, lhs.mNumCols}) && lhs.isSmall() && rhs.isSmall()) {
+        static constexpr auto kernels = makeEqualsKernels<SmallMatrix::mSmallSize>(std::make_index_sequence<numUnrolledSizes * numUnrolledSizes>());
+        return kernels[unrolledKernelIndex(lhs.mNumRows, lhs.mNumCols)](lhs.mStackData, rhs.mStackData, epsilon);
+    }
+
+    // Chunks stop early once any chunk has found a difference
+    std::atomic<bool> isEqual {true};
+    lhs.forEachRowChunk([&](int firstRow, int lastRow) {
+        for (int i {firstRow}; i < lastRow && isEqual.load(std::memory_order_relaxed); i++) {
+            double const* lhsRow = lhs.rowData(i);
+            double const* rhsRow = rhs.rowData(i);
+            for (int j {}; j < lhs.mNumCols; j++) {
+                if (std::abs(lhsRow[j] - rhsRow[j]) > epsilon) {
+                    isEqual.store(false, std::memory_order_relaxed);
+                    return;
+                }
+            }
+        }
+    }, policy, Tuner::parameters().copyParallelThreshold);
+    return isEqual.load();
+}
+
 SmallMatrix operator+(SmallMatrix const& lhs, SmallMatrix const& rhs) { 
+    return add(lhs, rhs, ExecutionPolicy::Parallel);
+}
+
+SmallMatrix operator-(SmallMatrix const& lhs, SmallMatrix const& rhs) { 
+    return subtract(lhs, rhs, ExecutionPolicy::Parallel);
+}
+
+SmallMatrix add(SmallMatrix const& lhs, SmallMatrix const& rhs, ExecutionPolicy policy) {
     if (lhs.mNumRows != rhs.mNumRows || lhs.mNumCols != rhs.mNumCols) {
         throw std::invalid_argument("Unequal dimensions!");
-
     }
 
     SmallMatrix m = SmallMatrix(lhs.mNumRows, lhs.mNumCols);
-
-    for (int i {}; i < lhs.mNumRows; i++) {
-        for (int j {}; j < lhs.mNumCols; j++) { 
-            m(i, j) = lhs(i, j) + rhs(i, j);
-        }
+    if (isUnrolledShape({lhs.mNumRows, lhs.mNumCols}) && lhs.isSmall() && rhs.isSmall() && m.isSmall()) {
+        static constexpr auto kernels = makeAddKernels<SmallMatrix::mSmallSize>(std::make_index_sequence<numUnrolledSizes * numUnrolledSizes>());
+        kernels[unrolledKernelIndex(lhs.mNumRows, lhs.mNumCols)](lhs.mStackData, rhs.mStackData, m.mStackData);
+        return m;
     }
+    lhs.forEachRowChunk([&](int firstRow, int lastRow) {
+        for (int i {firstRow}; i < lastRow; i++) {
+            std::transform(lhs.rowData(i), lhs.rowData(i) + lhs.mNumCols, rhs.rowData(i), m.rowData(i), std::plus<double>());
+        }
+    }, policy, Tuner::parameters().copyParallelThreshold);
     return m;
 }
 
-SmallMatrix operator-(SmallMatrix const& lhs, SmallMatrix const& rhs) { 
+SmallMatrix subtract(SmallMatrix const& lhs, SmallMatrix const& rhs, ExecutionPolicy policy) {
     if (lhs.mNumRows != rhs.mNumRows || lhs.mNumCols != rhs.mNumCols) {
         throw std::invalid_argument("Unequal dimensions!");
-
     }
 
     SmallMatrix m = SmallMatrix(lhs.mNumRows, lhs.mNumCols);
-
-    for (int i {}; i < lhs.mNumRows; i++) {
-        for (int j {}; j < lhs.mNumCols; j++) { 
-            m(i, j) = lhs(i, j) - rhs(i, j);
+    lhs.forEachRowChunk([&](int firstRow, int lastRow) {
+        for (int i {firstRow}; i < lastRow; i++) {
+            std::transform(lhs.rowData(i), lhs.rowData(i) + lhs.mNumCols, rhs.rowData(i), m.rowData(i), std::minus<double>());
         }
-    }
+    }, policy, Tuner::parameters().copyParallelThreshold);
     return m;
 }
 
 SmallMatrix operator*(SmallMatrix const& lhs, SmallMatrix const& rhs) {
-    const bool unequalDimensions = (lhs.mNumRows != rhs.mNumRows) || (lhs.mNumCols != rhs.mNumCols);
+    return multiply(lhs, rhs, ExecutionPolicy::Parallel);
+}
+
+SmallMatrix multiply(SmallMatrix const& lhs, SmallMatrix const& rhs, ExecutionPolicy policy) {
     if (lhs.mNumCols != rhs.mNumRows) {
         throw std::invalid_argument("Unequal dimensions!");
     }
     SmallMatrix newSmallMatrix = SmallMatrix(lhs.mNumRows, rhs.mNumCols);
+    SmallMatrix::multiplyInto(lhs, rhs, newSmallMatrix, policy);
+    return newSmallMatrix;
+}
 
-    for(int i = 0; i < lhs.mNumRows; i++) {
-        for(int j = 0; j < rhs.mNumCols; j++) {
-            for(int k = 0; k < lhs.mNumCols; k++) {
-                newSmallMatrix(i, j) += lhs(i, k) * rhs(k, j);
-            }
-        }
+SmallMatrix operator+(SmallMatrix::ConstBlock const& lhs, SmallMatrix::ConstBlock const& rhs) {
+    SmallMatrix newSmallMatrix = SmallMatrix(lhs);
+    newSmallMatrix.block(0, 0, lhs.mNumRows, lhs.mNumCols) += rhs;
+    return newSmallMatrix;
+}
+
+SmallMatrix operator-(SmallMatrix::ConstBlock const& lhs, SmallMatrix::ConstBlock const& rhs) {
+    SmallMatrix newSmallMatrix = SmallMatrix(lhs);
+    newSmallMatrix.block(0, 0, lhs.mNumRows, lhs.mNumCols) -= rhs;
+    return newSmallMatrix;
+}
+
+SmallMatrix operator*(SmallMatrix::ConstBlock const& lhs, SmallMatrix::ConstBlock const& rhs) {
+    if (lhs.mNumCols != rhs.mNumRows) {
+        throw std::invalid_argument("Unequal dimensions!");
     }
+    SmallMatrix newSmallMatrix = SmallMatrix(lhs.mNumRows, rhs.mNumCols, 0.0);
+    multiplyAdd(lhs, rhs, newSmallMatrix.block(0, 0, lhs.mNumRows, rhs.mNumCols));
+    return newSmallMatrix;
+}
 
+SmallMatrix operator*(double s, SmallMatrix::ConstBlock const& block) {
+    SmallMatrix newSmallMatrix = SmallMatrix(block);
+    newSmallMatrix.block(0, 0, block.mNumRows, block.mNumCols) *= s;
     return newSmallMatrix;
 }
 
+SmallMatrix operator*(SmallMatrix::ConstBlock const& block, double s) {
+    return operator*(s, block);
+}
+
 SmallMatrix operator*(double s, SmallMatrix const& sm) {
+    return multiply(s, sm, ExecutionPolicy::Parallel);
+}
+
+SmallMatrix multiply(double s, SmallMatrix const& sm, ExecutionPolicy policy) {
     SmallMatrix newSmallMatrix = SmallMatrix(sm.mNumRows, sm.mNumCols);
-    const int rows = sm.mNumRows;
     const int cols = sm.mNumCols;
-    for (int i {}; i < rows; i++) {
-        for (int j {}; j < cols; j++) {
-            newSmallMatrix(i, j) = s*sm(i, j);
+    sm.forEachRowChunk([&](int firstRow, int lastRow) {
+        for (int i {firstRow}; i < lastRow; i++) {
+            double const* row = sm.rowData(i);
+            double* newRow = newSmallMatrix.rowData(i);
+            for (int j {}; j < cols; j++) {
+                newRow[j] = s * row[j];
+            }
         }
-    }
+    }, policy, Tuner::parameters().copyParallelThreshold);
     return newSmallMatrix;
 }
 
@@ -466,81 +968,723 @@ SmallMatrix operator*(SmallMatrix const& sm, double s) {
 
 }
 
-SmallMatrix& SmallMatrix::operator+=(SmallMatrix const& sm) {
-    if (mNumRows != sm.mNumRows || mNumCols != sm.mNumCols) {
+std::vector<double> operator*(SmallMatrix const& sm, std::vector<double> const& x) {
+    std::vector<double> y;
+    multiply(sm, x, y);
+    return y;
+}
+
+void multiply(SmallMatrix const& sm, std::vector<double> const& x, std::vector<double>& out) {
+    if (static_cast<int>(x.size()) != sm.mNumCols) {
         throw std::invalid_argument("Unequal dimensions!");
     }
+    if (&out == &x) {
+        throw std::invalid_argument("Output vector must not be the input vector!");
+    }
 
-    SmallMatrix m = SmallMatrix(mNumRows, sm.mNumCols);
+    out.resize(sm.mNumRows);
+    for (int i {}; i < sm.mNumRows; i++) {
+        out[i] = dotProduct(sm.rowData(i), x.data(), sm.mNumCols);
+    }
+}
+
+std::vector<double> multiplyTransposed(SmallMatrix const& sm, std::vector<double> const& x) {
+    std::vector<double> y;
+    multiplyTransposed(sm, x, y);
+    return y;
+}
+
+void multiplyTransposed(SmallMatrix const& sm, std::vector<double> const& x, std::vector<double>& out) {
+    if (static_cast<int>(x.size()) != sm.mNumRows) {
+        throw std::invalid_argument("Unequal dimensions!");
+    }
+    if (&out == &x) {
+        throw std::invalid_argument("Output vector must not be the input vector!");
+    }
+
+    // Accumulate scaled rows, so the matrix is read in storage order
+    out.assign(sm.mNumCols, 0.0);
+    for (int i {}; i < sm.mNumRows; i++) {
+        double const* row = sm.rowData(i);
+        const double scalar = x[i];
+        for (int j {}; j < sm.mNumCols; j++) {
+            out[j] += scalar * row[j];
+        }
+    }
+}
+
+SmallMatrix outerProduct(std::vector<double> const& x, std::vector<double> const& y) {
+    SmallMatrix newSmallMatrix = SmallMatrix(x.size(), y.size());
+    for (int i {}; i < newSmallMatrix.mNumRows; i++) {
+        double* row = newSmallMatrix.rowData(i);
+        const double scalar = x[i];
+        for (int j {}; j < newSmallMatrix.mNumCols; j++) {
+            row[j] = scalar * y[j];
+        }
+    }
+    return newSmallMatrix;
+}
+
+void SmallMatrix::addOuterProduct(double alpha, std::vector<double> const& x, std::vector<double> const& y) {
+    if (static_cast<int>(x.size()) != mNumRows || static_cast<int>(y.size()) != mNumCols) {
+        throw std::invalid_argument("Unequal dimensions!");
+    }
 
     for (int i {}; i < mNumRows; i++) {
-        for (int j {}; j < mNumCols; j++) { 
-            (*this)(i, j) = (*this)(i, j) + sm(i, j);
+        double* row = rowData(i);
+        const double scalar = alpha * x[i];
+        for (int j {}; j < mNumCols; j++) {
+            row[j] += scalar * y[j];
+        }
+    }
+}
+
+void SmallMatrix::transformPoints(double const* points, double* results, int numPoints) const {
+    if (numPoints < 0) {
+        throw std::invalid_argument("Negative number of points!");
+    }
+
+    // Pack the matrix contiguously once, so every point reads it from a single small block
+    const int rows = mNumRows;
+    const int cols = mNumCols;
+    std::vector<double> packed(rows * cols);
+    for (int i {}; i < rows; i++) {
+        std::copy(rowData(i), rowData(i) + cols, packed.begin() + i * cols);
+    }
+    double const* matrix = packed.data();
+
+    const int pointsPerChunk = std::max(1, mChunkSize / std::max(1, rows * cols));
+    const int numChunks = (numPoints + pointsPerChunk - 1) / pointsPerChunk;
+    const bool parallel = static_cast<long long>(numPoints) * rows * cols >= Tuner::parameters().parallelThreshold;
+    detail::parallelFor(numChunks, [&](int chunk) {
+        const int lastPoint = std::min(numPoints, (chunk + 1) * pointsPerChunk);
+        for (int p {chunk * pointsPerChunk}; p < lastPoint; p++) {
+            double const* point = points + static_cast<long long>(p) * cols;
+            double* result = results + static_cast<long long>(p) * rows;
+            for (int i {}; i < rows; i++) {
+                result[i] = dotProduct(matrix + i * cols, point, cols);
+            }
         }
+    }, parallel);
+}
+
+std::vector<double> SmallMatrix::transformPoints(std::vector<double> const& points) const {
+    if (mNumCols == 0 ? !points.empty() : points.size() % mNumCols != 0) {
+        throw std::invalid_argument("Number of elements is not a multiple of the number of columns!");
     }
+
+    const int numPoints = mNumCols == 0 ? 0 : points.size() / mNumCols;
+    std::vector<double> results(static_cast<std::size_t>(numPoints) * mNumRows);
+    transformPoints(points.data(), results.data(), numPoints);
+    return results;
+}
+
+SmallMatrix& SmallMatrix::operator+=(SmallMatrix const& sm) {
+    return addAssign(sm, ExecutionPolicy::Parallel);
+}
+
+SmallMatrix& SmallMatrix::addAssign(SmallMatrix const& sm, ExecutionPolicy policy) {
+    if (mNumRows != sm.mNumRows || mNumCols != sm.mNumCols) {
+        throw std::invalid_argument("Unequal dimensions!");
+    }
+
+    // Detach copy-on-write data once, rather than from every chunk that writes a row
+    if (mIsLargeMatrix) {
+        mutableHeapData();
+    }
+    forEachRowChunk([&](int firstRow, int lastRow) {
+        for (int i {firstRow}; i < lastRow; i++) {
+            double* row = rowData(i);
+            std::transform(row, row + mNumCols, sm.rowData(i), row, std::plus<double>());
+        }
+    }, policy, Tuner::parameters().copyParallelThreshold);
     return *this;
 }
 
 SmallMatrix& SmallMatrix::operator-=(SmallMatrix const& sm) {
+    return subtractAssign(sm, ExecutionPolicy::Parallel);
+}
+
+SmallMatrix& SmallMatrix::subtractAssign(SmallMatrix const& sm, ExecutionPolicy policy) {
     if (mNumRows != sm.mNumRows || mNumCols != sm.mNumCols) {
         throw std::invalid_argument("Unequal dimensions!");
     }
 
-    SmallMatrix m = SmallMatrix(mNumRows, sm.mNumCols);
-
-    for (int i {}; i < mNumRows; i++) {
-        for (int j {}; j < mNumCols; j++) { 
-            (*this)(i, j) = (*this)(i, j) - sm(i, j);
-        }
+    // Detach copy-on-write data once, rather than from every chunk that writes a row
+    if (mIsLargeMatrix) {
+        mutableHeapData();
     }
+    forEachRowChunk([&](int firstRow, int lastRow) {
+        for (int i {firstRow}; i < lastRow; i++) {
+            double* row = rowData(i);
+            std::transform(row, row + mNumCols, sm.rowData(i), row, std::minus<double>());
+        }
+    }, policy, Tuner::parameters().copyParallelThreshold);
     return *this;
 }
 
 SmallMatrix& SmallMatrix::operator*=(SmallMatrix const& sm) {
+    return multiplyAssign(sm, ExecutionPolicy::Parallel);
+}
+
+SmallMatrix& SmallMatrix::multiplyAssign(SmallMatrix const& sm, ExecutionPolicy policy) {
     if (mNumCols != sm.mNumRows) {
         throw std::invalid_argument("Unequal dimensions!");
     }
 
     SmallMatrix newSmallMatrix = SmallMatrix(mNumRows, sm.mNumCols);
+    multiplyInto(*this, sm, newSmallMatrix, policy);
 
-
-    for(int i = 0; i < mNumRows; i++) {
-        for(int j = 0; j < sm.mNumCols; j++) {
-            for(int k = 0; k < mNumCols; k++) {
-                newSmallMatrix(i, j) += (*this)(i, k) * sm(k, j);
-            }
-        }
-    }
-    
-    *this = newSmallMatrix;
+    *this = std::move(newSmallMatrix);
     return *this;
 }
 
 SmallMatrix& SmallMatrix::operator*=(double s) {
-    for (int i {}; i < mNumRows; i++) {
-        for (int j {}; j < mNumCols; j++) {
-            (*this)(i, j) *= s;
-        }
+    return multiplyAssign(s, ExecutionPolicy::Parallel);
+}
+
+SmallMatrix& SmallMatrix::multiplyAssign(double s, ExecutionPolicy policy) {
+    // Detach copy-on-write data once, rather than from every chunk that writes a row
+    if (mIsLargeMatrix) {
+        mutableHeapData();
     }
+    forEachRowChunk([&](int firstRow, int lastRow) {
+        for (int i {firstRow}; i < lastRow; i++) {
+            double* row = rowData(i);
+            for (int j {}; j < mNumCols; j++) {
+                row[j] *= s;
+            }
+        }
+    }, policy, Tuner::parameters().copyParallelThreshold);
     return *this;
 }
 
 SmallMatrix transpose(SmallMatrix const& sm) {
+    return transpose(sm, ExecutionPolicy::Parallel);
+}
+
+SmallMatrix transpose(SmallMatrix const& sm, ExecutionPolicy policy) {
+    // Every path returns the same matrix, so it is constructed in place rather than copied
     SmallMatrix newSmallMatrix = SmallMatrix(sm.mNumCols, sm.mNumRows);
+    if (isUnrolledShape({sm.mNumRows, sm.mNumCols}) && sm.isSmall() && newSmallMatrix.isSmall()) {
+        static constexpr auto kernels = makeTransposeKernels<SmallMatrix::mSmallSize>(std::make_index_sequence<numUnrolledSizes * numUnrolledSizes>());
+        kernels[unrolledKernelIndex(sm.mNumRows, sm.mNumCols)](sm.mStackData, newSmallMatrix.mStackData);
+        return newSmallMatrix;
+    }
 
-    const int rows = sm.mNumRows;
-    const int cols = sm.mNumCols;
+    auto const parameters = Tuner::parameters();
+    const bool parallel = isParallelWork(policy, static_cast<long long>(sm.mNumRows) * sm.mNumCols,
+                                         parameters.transposeParallelThreshold);
+    SmallMatrix::transposeKernel(SmallMatrix::ConstBlock(sm), newSmallMatrix, parameters.transposeBlockSize, parallel);
+    return newSmallMatrix;
+}
 
-    for (int i {}; i < rows; i++) {
-        for (int j {}; j < cols; j++) {
-            if (newSmallMatrix.mIsLargeMatrix) {
-                newSmallMatrix.mHeapData.at(j).at(i) = sm.mHeapData.at(i).at(j);
+SmallMatrix transpose(SmallMatrix::ConstBlock const& block) {
+    return transpose(block, ExecutionPolicy::Parallel);
+}
+
+SmallMatrix transpose(SmallMatrix::ConstBlock const& block, ExecutionPolicy policy) {
+    SmallMatrix newSmallMatrix = SmallMatrix(block.mNumCols, block.mNumRows);
+    auto const parameters = Tuner::parameters();
+    const bool parallel = isParallelWork(policy, static_cast<long long>(block.mNumRows) * block.mNumCols,
+                                         parameters.transposeParallelThreshold);
+    SmallMatrix::transposeKernel(block, newSmallMatrix, parameters.transposeBlockSize, parallel);
+    return newSmallMatrix;
+}
+
+void SmallMatrix::transposeKernel(ConstBlock const& block, SmallMatrix& out, int tileSize, bool parallel) {
+    const int rows = block.mNumRows;
+    const int cols = block.mNumCols;
+    const int numColTiles = (cols + tileSize - 1) / tileSize;
+
+    // Transpose tile by tile, so both the rows read and the rows written stay in cache. Each task
+    // takes one column of tiles, so every row of the result is written by a single thread.
+    detail::parallelFor(numColTiles, [&](int colTile) {
+        const int jj = colTile * tileSize;
+        const int jEnd = std::min(jj + tileSize, cols);
+        for (int ii {}; ii < rows; ii += tileSize) {
+            const int iEnd = std::min(ii + tileSize, rows);
+            for (int i {ii}; i < iEnd; i++) {
+                double const* row = block.rowData(i);
+                for (int j {jj}; j < jEnd; j++) {
+                    out.rowData(j)[i] = row[j];
+                }
+            }
+        }
+    }, parallel);
+}
+
+void multiplyAdd(SmallMatrix const& lhs, SmallMatrix const& rhs, SmallMatrix& out) {
+    multiplyAdd(lhs, rhs, out, ExecutionPolicy::Parallel);
+}
+
+void multiplyAdd(SmallMatrix const& lhs, SmallMatrix const& rhs, SmallMatrix& out, ExecutionPolicy policy) {
+    if (lhs.mNumCols != rhs.mNumRows || out.mNumRows != lhs.mNumRows || out.mNumCols != rhs.mNumCols) {
+        throw std::invalid_argument("Unequal dimensions!");
+    }
+    if (&out == &lhs || &out == &rhs) {
+        throw std::invalid_argument("Output matrix aliases an operand!");
+    }
+
+    multiplyAdd(SmallMatrix::ConstBlock(lhs), SmallMatrix::ConstBlock(rhs), out.block(0, 0, out.mNumRows, out.mNumCols), policy);
+}
+
+void multiplyAdd(SmallMatrix::ConstBlock const& lhs, SmallMatrix::ConstBlock const& rhs, SmallMatrix::Block const& out) {
+    multiplyAdd(lhs, rhs, out, ExecutionPolicy::Parallel);
+}
+
+void multiplyAdd(SmallMatrix::ConstBlock const& lhs, SmallMatrix::ConstBlock const& rhs, SmallMatrix::Block const& out, ExecutionPolicy policy) {
+    if (lhs.mNumCols != rhs.mNumRows || out.mNumRows != lhs.mNumRows || out.mNumCols != rhs.mNumCols) {
+        throw std::invalid_argument("Unequal dimensions!");
+    }
+    if (lhs.overlaps(out) || rhs.overlaps(out)) {
+        throw std::invalid_argument("Output block overlaps an operand!");
+    }
+
+    auto const parameters = Tuner::parameters();
+    const bool parallel = isParallelWork(policy, static_cast<long long>(lhs.mNumRows) * lhs.mNumCols * rhs.mNumCols,
+                                         parameters.multiplyParallelThreshold);
+    SmallMatrix::multiplyKernel(lhs, rhs, out, parameters.multiplyBlockSize, parameters.multiplyKernel, parallel);
+}
+
+void SmallMatrix::multiplyKernel(ConstBlock const& lhs, ConstBlock const& rhs, Block const& out,
+                                 int blockSize, MultiplyKernel kernel, bool parallel) {
+    const int rows = lhs.mNumRows;
+    const int inner = lhs.mNumCols;
+    const int cols = rhs.mNumCols;
+    const int numRowBlocks = (rows + blockSize - 1) / blockSize;
+
+    // Detach copy-on-write data once, rather than from every task that writes a row
+    if (out.mMatrix->mIsLargeMatrix) {
+        out.mMatrix->mutableHeapData();
+    }
+
+    // Blocked i-k-j loop: a block of rhs rows stays in cache while every row of lhs streams
+    // through it, and the innermost loop runs over contiguous memory. Each task owns a block of
+    // output rows, so the elements are accumulated in the same order whatever the policy.
+    detail::parallelFor(numRowBlocks, [&](int rowBlock) {
+        const int firstRow = rowBlock * blockSize;
+        const int lastRow = std::min(firstRow + blockSize, rows);
+        for (int kk {}; kk < inner; kk += blockSize) {
+            const int kEnd = std::min(kk + blockSize, inner);
+            for (int jj {}; jj < cols; jj += blockSize) {
+                const int jEnd = std::min(jj + blockSize, cols);
+                int i {firstRow};
+
+                // The register-tiled kernel reuses each loaded rhs element for four output rows
+                if (kernel == MultiplyKernel::RegisterTiled) {
+                    for (; i + 4 <= lastRow; i += 4) {
+                        double const* lhsRows[4] {lhs.rowData(i), lhs.rowData(i + 1), lhs.rowData(i + 2), lhs.rowData(i + 3)};
+                        double* outRows[4] {out.rowData(i), out.rowData(i + 1), out.rowData(i + 2), out.rowData(i + 3)};
+                        for (int k {kk}; k < kEnd; k++) {
+                            const double scalar0 = lhsRows[0][k];
+                            const double scalar1 = lhsRows[1][k];
+                            const double scalar2 = lhsRows[2][k];
+                            const double scalar3 = lhsRows[3][k];
+                            double const* rhsRow = rhs.rowData(k);
+                            for (int j {jj}; j < jEnd; j++) {
+                                const double rhsElement = rhsRow[j];
+                                outRows[0][j] += scalar0 * rhsElement;
+                                outRows[1][j] += scalar1 * rhsElement;
+                                outRows[2][j] += scalar2 * rhsElement;
+                                outRows[3][j] += scalar3 * rhsElement;
+                            }
+                        }
+                    }
+                }
+                for (; i < lastRow; i++) {
+                    double const* lhsRow = lhs.rowData(i);
+                    double* outRow = out.rowData(i);
+                    for (int k {kk}; k < kEnd; k++) {
+                        const double scalar = lhsRow[k];
+                        double const* rhsRow = rhs.rowData(k);
+                        for (int j {jj}; j < jEnd; j++) {
+                            outRow[j] += scalar * rhsRow[j];
+                        }
+                    }
+                }
+            }
+        }
+    }, parallel);
+}
+
+void SmallMatrix::multiplyInto(SmallMatrix const& lhs, SmallMatrix const& rhs, SmallMatrix& out, ExecutionPolicy policy) {
+    if (isUnrolledShape({lhs.mNumRows, lhs.mNumCols, rhs.mNumCols}) && lhs.isSmall() && rhs.isSmall() && out.isSmall()) {
+        static constexpr auto kernels = makeMultiplyKernels<mSmallSize>(std::make_index_sequence<numUnrolledSizes * numUnrolledSizes>());
+        kernels[unrolledKernelIndex(lhs.mNumCols, rhs.mNumCols)](lhs.mStackData, rhs.mStackData, out.mStackData, lhs.mNumRows);
+        return;
+    }
+    for (int i {}; i < out.mNumRows; i++) {
+        std::fill(out.rowData(i), out.rowData(i) + out.mNumCols, 0.0);
+    }
+    multiplyAdd(lhs, rhs, out, policy);
+}
+
+void SmallMatrix::multiplyChainInto(
+    std::vector<std::reference_wrapper<SmallMatrix const>> const& chain,
+    std::vector<int> const& split, SmallMatrix& out) {
+    const int numMatrices = chain.size();
+
+    // The split tree is walked in post-order with explicit stacks, so long chains cannot overflow
+    // the call stack. Single matrices are used in place. Intermediate products are held on the
+    // heap, and a buffer is handed back for reuse once its product has been consumed.
+    struct Frame {
+        int first;
+        int last;
+        bool isExpanded;
+    };
+    struct Operand {
+        SmallMatrix const* matrix;
+        int buffer;
+    };
+    std::vector<Frame> frames {{0, numMatrices - 1, false}};
+    std::vector<Operand> operands;
+    std::vector<std::unique_ptr<SmallMatrix>> buffers;
+    std::vector<int> freeBuffers;
+
+    while (!frames.empty()) {
+        const Frame frame = frames.back();
+        if (frame.first == frame.last) {
+            frames.pop_back();
+            operands.push_back({&chain.at(frame.first).get(), -1});
+            continue;
+        }
+
+        // The left sub-chain is pushed last so that it is evaluated first
+        const int k = split.at(frame.first * numMatrices + frame.last);
+        if (!frame.isExpanded) {
+            frames.back().isExpanded = true;
+            frames.push_back({k + 1, frame.last, false});
+            frames.push_back({frame.first, k, false});
+            continue;
+        }
+        frames.pop_back();
+
+        const Operand right = operands.back();
+        operands.pop_back();
+        const Operand left = operands.back();
+        operands.pop_back();
+
+        SmallMatrix* product = &out;
+        int buffer {-1};
+        if (!frames.empty()) {
+            if (freeBuffers.empty()) {
+                freeBuffers.push_back(buffers.size());
+                buffers.push_back(std::make_unique<SmallMatrix>());
+            }
+            buffer = freeBuffers.back();
+            freeBuffers.pop_back();
+            product = buffers.at(buffer).get();
+            product->resize(left.matrix->mNumRows, right.matrix->mNumCols);
+        }
+        multiplyInto(*left.matrix, *right.matrix, *product);
+
+        for (int consumed : {left.buffer, right.buffer}) {
+            if (consumed >= 0) {
+                freeBuffers.push_back(consumed);
+            }
+        }
+        operands.push_back({product, buffer});
+    }
+}
+
+SmallMatrix multiplyChain(std::vector<std::reference_wrapper<SmallMatrix const>> const& chain) {
+    if (chain.empty()) {
+        throw std::invalid_argument("Empty matrix chain!");
+    }
+
+    // Matrix i has dimensions dims[i] x dims[i + 1]
+    const int numMatrices = chain.size();
+    std::vector<long long> dims(numMatrices + 1);
+    dims.at(0) = chain.front().get().mNumRows;
+    for (int i {}; i < numMatrices; i++) {
+        if (chain.at(i).get().mNumRows != dims.at(i)) {
+            throw std::invalid_argument("Unequal dimensions!");
+        }
+        dims.at(i + 1) = chain.at(i).get().mNumCols;
+    }
+
+    if (numMatrices == 1) {
+        return chain.front().get();
+    }
+
+    // cost[i][j] is the cheapest number of scalar multiplications for chain[i..j], and split[i][j]
+    // is the index k such that the cheapest order is (chain[i..k]) * (chain[k+1..j])
+    std::vector<long long> cost(numMatrices * numMatrices, 0);
+    std::vector<int> split(numMatrices * numMatrices, 0);
+    for (int length {2}; length <= numMatrices; length++) {
+        for (int i {}; i + length - 1 < numMatrices; i++) {
+            const int j = i + length - 1;
+            long long best = -1;
+            for (int k {i}; k < j; k++) {
+                const long long candidate = cost.at(i * numMatrices + k)
+                    + cost.at((k + 1) * numMatrices + j) + dims.at(i) * dims.at(k + 1) * dims.at(j + 1);
+                if (best < 0 || candidate < best) {
+                    best = candidate;
+                    split.at(i * numMatrices + j) = k;
+                }
+            }
+            cost.at(i * numMatrices + j) = best;
+        }
+    }
+
+    SmallMatrix result = SmallMatrix(dims.front(), dims.back());
+    SmallMatrix::multiplyChainInto(chain, split, result);
+
+    return result;
+}
+
+SmallMatrix pow(SmallMatrix const& sm, int n) {
+    if (sm.mNumRows != sm.mNumCols) {
+        throw std::invalid_argument("Matrix is not square!");
+    }
+    if (n < 0) {
+        throw std::invalid_argument("Negative exponent!");
+    }
+
+    const int size = sm.mNumRows;
+    if (n == 0) {
+        SmallMatrix identity = SmallMatrix(size, size, 0.0);
+        for (int i {}; i < size; i++) {
+            identity.rowData(i)[i] = 1.0;
+        }
+        return identity;
+    }
+
+    // The three buffers rotate roles by pointer, so no matrix is allocated inside the loop
+    SmallMatrix base = sm;
+    SmallMatrix result = SmallMatrix(size, size);
+    SmallMatrix scratch = SmallMatrix(size, size);
+    SmallMatrix* pBase = &base;
+    SmallMatrix* pResult = &result;
+    SmallMatrix* pScratch = &scratch;
+    bool hasResult = false;
+
+    while (true) {
+        if (n & 1) {
+            if (hasResult) {
+                SmallMatrix::multiplyInto(*pResult, *pBase, *pScratch);
+                std::swap(pResult, pScratch);
             } else {
-                newSmallMatrix.mStackData.at(j).at(i) = sm.mStackData.at(i).at(j);
+                *pResult = *pBase;
+                hasResult = true;
             }
         }
+        n >>= 1;
+        if (n == 0) {
+            break;
+        }
+        SmallMatrix::multiplyInto(*pBase, *pBase, *pScratch);
+        std::swap(pBase, pScratch);
     }
-    return newSmallMatrix;
+    return std::move(*pResult);
+}
+
+SmallMatrix solve(SmallMatrix const& lhs, SmallMatrix const& rhs) {
+    if (lhs.mNumRows != lhs.mNumCols) {
+        throw std::invalid_argument("Matrix is not square!");
+    }
+    if (lhs.mNumRows != rhs.mNumRows) {
+        throw std::invalid_argument("Unequal dimensions!");
+    }
+
+    const int size = lhs.mNumRows;
+    const int rhsCols = rhs.mNumCols;
+    SmallMatrix factors = lhs;
+    SmallMatrix solution = rhs;
+
+    // Forward elimination, swapping the row with the largest pivot into place at each step
+    for (int k {}; k < size; k++) {
+        int pivotRow {k};
+        for (int i {k + 1}; i < size; i++) {
+            if (std::abs(factors.rowData(i)[k]) > std::abs(factors.rowData(pivotRow)[k])) {
+                pivotRow = i;
+            }
+        }
+        if (factors.rowData(pivotRow)[k] == 0.0) {
+            throw std::invalid_argument("Singular matrix!");
+        }
+        if (pivotRow != k) {
+            std::swap_ranges(factors.rowData(k), factors.rowData(k) + size, factors.rowData(pivotRow));
+            std::swap_ranges(solution.rowData(k), solution.rowData(k) + rhsCols, solution.rowData(pivotRow));
+        }
+
+        double const* pivotFactors = factors.rowData(k);
+        double const* pivotSolution = solution.rowData(k);
+        for (int i {k + 1}; i < size; i++) {
+            double* rowFactors = factors.rowData(i);
+            double* rowSolution = solution.rowData(i);
+            const double multiplier = rowFactors[k] / pivotFactors[k];
+            for (int j {k + 1}; j < size; j++) {
+                rowFactors[j] -= multiplier * pivotFactors[j];
+            }
+            for (int j {}; j < rhsCols; j++) {
+                rowSolution[j] -= multiplier * pivotSolution[j];
+            }
+        }
+    }
+
+    // Back substitution, one row of the solution at a time
+    for (int i {size - 1}; i >= 0; i--) {
+        double const* rowFactors = factors.rowData(i);
+        double* rowSolution = solution.rowData(i);
+        for (int k {i + 1}; k < size; k++) {
+            double const* solvedRow = solution.rowData(k);
+            for (int j {}; j < rhsCols; j++) {
+                rowSolution[j] -= rowFactors[k] * solvedRow[j];
+            }
+        }
+        for (int j {}; j < rhsCols; j++) {
+            rowSolution[j] /= rowFactors[i];
+        }
+    }
+    return solution;
+}
+
+int SmallMatrix::rowsPerChunk() const {
+    return std::max(1, mChunkSize / std::max(1, mNumCols));
+}
+
+bool SmallMatrix::isParallelSized(ExecutionPolicy policy, int parallelThreshold) const {
+    return isParallelWork(policy, getNumberOfElements(*this), parallelThreshold);
+}
+
+void SmallMatrix::forEachRowChunk(std::function<void(int, int)> const& rowFunction,
+                                  ExecutionPolicy policy, int parallelThreshold) const {
+    const int chunkRows = rowsPerChunk();
+    const int numChunks = (mNumRows + chunkRows - 1) / chunkRows;
+    detail::parallelFor(numChunks, [&](int chunk) {
+        rowFunction(chunk * chunkRows, std::min(mNumRows, (chunk + 1) * chunkRows));
+    }, isParallelSized(policy, parallelThreshold));
+}
+
+void SmallMatrix::resizeHeapRows(ExecutionPolicy policy) {
+    auto& heapRows = mutableHeapData();
+    heapRows.resize(mNumRows);
+    forEachRowChunk([&](int firstRow, int lastRow) {
+        for (int i {firstRow}; i < lastRow; i++) {
+            heapRows[i].resize(mNumCols, 0);
+        }
+    }, policy, Tuner::parameters().copyParallelThreshold);
+}
+
+double SmallMatrix::sum(ExecutionPolicy policy) const {
+    // One partial sum per chunk, combined in chunk order so the result is deterministic
+    const int chunkRows = rowsPerChunk();
+    std::vector<double> partialSums((mNumRows + chunkRows - 1) / chunkRows);
+    forEachRowChunk([&](int firstRow, int lastRow) {
+        CompensatedSum chunkSum;
+        for (int i {firstRow}; i < lastRow; i++) {
+            chunkSum.add(pairwiseSum(rowData(i), mNumCols, [](double e) { return e; }));
+        }
+        partialSums.at(firstRow / chunkRows) = chunkSum.result();
+    }, policy);
+
+    CompensatedSum total;
+    std::for_each(partialSums.cbegin(), partialSums.cend(), [&](double e) { total.add(e); });
+    return total.result();
+}
+
+double SmallMatrix::trace() const {
+    if (mNumRows != mNumCols) {
+        throw std::invalid_argument("Matrix is not square!");
+    }
+
+    CompensatedSum total;
+    for (int i {}; i < mNumRows; i++) {
+        total.add(rowData(i)[i]);
+    }
+    return total.result();
+}
+
+double SmallMatrix::frobeniusNorm(ExecutionPolicy policy) const {
+    const int chunkRows = rowsPerChunk();
+    std::vector<double> partialSums((mNumRows + chunkRows - 1) / chunkRows);
+    forEachRowChunk([&](int firstRow, int lastRow) {
+        CompensatedSum chunkSum;
+        for (int i {firstRow}; i < lastRow; i++) {
+            chunkSum.add(pairwiseSum(rowData(i), mNumCols, [](double e) { return e * e; }));
+        }
+        partialSums.at(firstRow / chunkRows) = chunkSum.result();
+    }, policy);
+
+    CompensatedSum total;
+    std::for_each(partialSums.cbegin(), partialSums.cend(), [&](double e) { total.add(e); });
+    return std::sqrt(total.result());
+}
+
+double SmallMatrix::infinityNorm(ExecutionPolicy policy) const {
+    const int chunkRows = rowsPerChunk();
+    std::vector<double> partialMaxima((mNumRows + chunkRows - 1) / chunkRows);
+    forEachRowChunk([&](int firstRow, int lastRow) {
+        double chunkMax {};
+        for (int i {firstRow}; i < lastRow; i++) {
+            chunkMax = std::max(chunkMax, pairwiseSum(rowData(i), mNumCols, [](double e) { return std::abs(e); }));
+        }
+        partialMaxima.at(firstRow / chunkRows) = chunkMax;
+    }, policy);
+
+    return partialMaxima.empty() ? 0.0 : *std::max_element(partialMaxima.cbegin(), partialMaxima.cend());
+}
+
+double SmallMatrix::min(ExecutionPolicy policy) const {
+    auto const index = argMin(policy);
+    return rowData(index.first)[index.second];
+}
+
+double SmallMatrix::max(ExecutionPolicy policy) const {
+    auto const index = argMax(policy);
+    return rowData(index.first)[index.second];
+}
+
+std::pair<int, int> SmallMatrix::argMin(ExecutionPolicy policy) const {
+    if (getNumberOfElements(*this) == 0) {
+        throw std::out_of_range("Out of Range! Matrix has no elements");
+    }
+
+    // Each chunk keeps its first minimum and the chunks are compared in order, so ties always
+    // resolve to the first element in row-major order
+    const int chunkRows = rowsPerChunk();
+    std::vector<std::pair<int, int>> partialIndices((mNumRows + chunkRows - 1) / chunkRows);
+    forEachRowChunk([&](int firstRow, int lastRow) {
+        std::pair<int, int> best {firstRow, 0};
+        for (int i {firstRow}; i < lastRow; i++) {
+            double const* row = rowData(i);
+            const int j = std::min_element(row, row + mNumCols) - row;
+            if (row[j] < rowData(best.first)[best.second]) {
+                best = {i, j};
+            }
+        }
+        partialIndices.at(firstRow / chunkRows) = best;
+    }, policy);
+
+    return *std::min_element(partialIndices.cbegin(), partialIndices.cend(), [&](auto const& lhs, auto const& rhs) {
+        return rowData(lhs.first)[lhs.second] < rowData(rhs.first)[rhs.second];
+    });
+}
+
+std::pair<int, int> SmallMatrix::argMax(ExecutionPolicy policy) const {
+    if (getNumberOfElements(*this) == 0) {
+        throw std::out_of_range("Out of Range! Matrix has no elements");
+    }
+
+    const int chunkRows = rowsPerChunk();
+    std::vector<std::pair<int, int>> partialIndices((mNumRows + chunkRows - 1) / chunkRows);
+    forEachRowChunk([&](int firstRow, int lastRow) {
+        std::pair<int, int> best {firstRow, 0};
+        for (int i {firstRow}; i < lastRow; i++) {
+            double const* row = rowData(i);
+            const int j = std::max_element(row, row + mNumCols) - row;
+            if (row[j] > rowData(best.first)[best.second]) {
+                best = {i, j};
+            }
+        }
+        partialIndices.at(firstRow / chunkRows) = best;
+    }, policy);
+
+    return *std::max_element(partialIndices.cbegin(), partialIndices.cend(), [&](auto const& lhs, auto const& rhs) {
+        return rowData(lhs.first)[lhs.second] < rowData(rhs.first)[rhs.second];
+    });
 }
 
 std::ostream& operator<<(std::ostream& os, SmallMatrix const& sm) {
@@ -556,4 +1700,82 @@ std::ostream& operator<<(std::ostream& os, SmallMatrix const& sm) {
     return os; 
 }
 
+namespace detail {
+
+double* rowData(SmallMatrix& sm, int numRow) { return sm.rowData(numRow); }
+
+double const* rowData(SmallMatrix const& sm, int numRow) { return sm.rowData(numRow); }
+
+namespace {
+
+// Shared between the caller of parallelFor and the helper tasks queued on the executor. Helpers
+// may start after every task has been claimed, so the state outlives the call.
+struct ParallelForState {
+    std::function<void(int)> const* task;
+    int numTasks;
+    std::atomic<int> nextTask {0};
+    int finishedTasks {0};
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable allFinished;
+};
+
+// Claims and runs tasks until none are left. After a task throws, the remaining tasks are claimed
+// but skipped.
+void runParallelForTasks(ParallelForState& state) {
+    for (int i = state.nextTask++; i < state.numTasks; i = state.nextTask++) {
+        std::exception_ptr error;
+        bool failed;
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            failed = static_cast<bool>(state.error);
+        }
+        if (!failed) {
+            try {
+                (*state.task)(i);
+            } catch (...) {
+                error = std::current_exception();
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (error && !state.error) {
+            state.error = error;
+        }
+        if (++state.finishedTasks == state.numTasks) {
+            state.allFinished.notify_all();
+        }
+    }
+}
+
+}  // namespace
+
+void parallelFor(int numTasks, std::function<void(int)> const& task, bool parallel) {
+    const int numThreads = parallel ? std::min(numTasks, Executor::instance().numThreads()) : 1;
+    if (numThreads <= 1) {
+        for (int i {}; i < numTasks; i++) {
+            task(i);
+        }
+        return;
+    }
+
+    // The calling thread works through the tasks as well, so parallelFor cannot deadlock when it is
+    // called from a task that is itself running on the executor
+    auto state = std::make_shared<ParallelForState>();
+    state->task = &task;
+    state->numTasks = numTasks;
+    for (int i {1}; i < numThreads; i++) {
+        Executor::instance().submit([state]() { runParallelForTasks(*state); });
+    }
+    runParallelForTasks(*state);
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->allFinished.wait(lock, [&]() { return state->finishedTasks == state->numTasks; });
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
+}  // namespace detail
+
 }  // namespace smallMatrix
\ No newline at end of file
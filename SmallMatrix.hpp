@@ -5,17 +5,234 @@
  */
 #pragma once
 
+#include "Tuner.hpp"
+
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <functional>
 #include <iostream>
+#include <memory>
 #include <stdexcept>
 #include <utility>
 #include <vector>
 
 namespace smallMatrix {
 
+class SmallMatrix;
+
+namespace detail {
+
+/**
+ * @brief Returns a pointer to the first element of the specified row of the matrix, for kernels
+ *        of other matrix types that work on SmallMatrix operands. The row index is not checked.
+ *
+ * @param sm SmallMatrix.
+ * @param numRow Row index.
+ * @return double*
+ */
+double* rowData(SmallMatrix& sm, int numRow);
+
+/**
+ * @brief Returns a pointer to the first element of constant type of the specified row of the
+ *        matrix. The row index is not checked.
+ *
+ * @param sm SmallMatrix.
+ * @param numRow Row index.
+ * @return double const*
+ */
+double const* rowData(SmallMatrix const& sm, int numRow);
+
+}  // namespace detail
+
+/**
+ * @brief Selects how a bulk operation on a matrix is run.
+ *
+ * Sequential runs the operation on the calling thread. Parallel splits it across the threads of the
+ * library's executor once the operation is large enough for the split to pay off, and runs it on
+ * the calling thread otherwise. ThreadPool always splits it across the executor's threads.
+ */
+enum class ExecutionPolicy { Sequential, Parallel, ThreadPool };
+
 class SmallMatrix {
 public:
+    class Block;
+
+    /**
+     * @brief A read-only view of a rectangular block of a matrix. No elements are copied, and the
+     *        view is invalidated by any operation that changes the dimensions of the matrix.
+     */
+    class ConstBlock {
+    public:
+        /**
+         * @brief A constructor which initialises a view of the whole of the specified matrix, so
+         *        that matrices can be passed wherever a block is expected.
+         *
+         * @param sm SmallMatrix to view.
+         */
+        ConstBlock(SmallMatrix const& sm);
+
+        /**
+         * @brief Returns the constant reference of the element at the specified row and column
+         *        index of the block.
+         *
+         * @param numRow Row index within the block.
+         * @param numCol Column index within the block.
+         * @return const double&
+         * @throw Throws out_of_range if the specified row and column is outside the range
+         *        [0, max_row) and [0, max_col) of the block respectively.
+         */
+        const double& operator()(int numRow, int numCol) const;
+
+        /**
+         * @brief Returns the size of the block where the first of the pair is the number of rows
+         *        and the second of the pair is the number of columns.
+         *
+         * @return std::pair<int, int>
+         */
+        std::pair<int, int> size() const;
+
+    private:
+        friend class SmallMatrix;
+        friend class Block;
+        friend SmallMatrix operator+(ConstBlock const& lhs, ConstBlock const& rhs);
+        friend SmallMatrix operator-(ConstBlock const& lhs, ConstBlock const& rhs);
+        friend SmallMatrix operator*(ConstBlock const& lhs, ConstBlock const& rhs);
+        friend SmallMatrix operator*(double s, ConstBlock const& block);
+        friend void multiplyAdd(ConstBlock const& lhs, ConstBlock const& rhs, Block const& out);
+        friend void multiplyAdd(ConstBlock const& lhs, ConstBlock const& rhs, Block const& out, ExecutionPolicy policy);
+        friend SmallMatrix transpose(ConstBlock const& block);
+        friend SmallMatrix transpose(ConstBlock const& block, ExecutionPolicy policy);
+
+        ConstBlock(SmallMatrix const* sm, int firstRow, int firstCol, int numRows, int numCols);
+
+        /**
+         * @brief Returns a pointer to the first element of constant type of the specified row of
+         *        the block. The row index is not checked.
+         *
+         * @param numRow Row index within the block.
+         * @return double const*
+         */
+        double const* rowData(int numRow) const;
+
+        /**
+         * @brief Returns true if the two blocks view overlapping elements of the same matrix.
+         *
+         * @param other Block to compare with.
+         * @return true, if any element is part of both blocks.
+         * @return false, otherwise.
+         */
+        bool overlaps(ConstBlock const& other) const;
+
+        SmallMatrix const* mMatrix;
+        int mFirstRow;
+        int mFirstCol;
+        int mNumRows;
+        int mNumCols;
+    };
+
+    /**
+     * @brief A writable view of a rectangular block of a matrix. Copying a Block copies the view,
+     *        while assigning to a Block copies elements into the viewed matrix. The view is
+     *        invalidated by any operation that changes the dimensions of the matrix.
+     */
+    class Block {
+    public:
+        /**
+         * @brief Returns a read-only view of the same block.
+         *
+         * @return ConstBlock
+         */
+        operator ConstBlock() const;
+
+        /**
+         * @brief Copies the elements of the specified block into this block, one row at a time.
+         *        Overlapping blocks of the same matrix are handled correctly.
+         *
+         * @param other Block, or matrix, to copy from.
+         * @return Block const&
+         * @throw Throws invalid_argument if the two blocks do not have the same dimensions.
+         */
+        Block const& operator=(ConstBlock const& other) const;
+
+        /**
+         * @brief Copies the elements of the specified block into this block.
+         *
+         * @param other Block to copy from.
+         * @return Block const&
+         * @throw Throws invalid_argument if the two blocks do not have the same dimensions.
+         */
+        Block const& operator=(Block const& other) const;
+
+        /**
+         * @brief Adds the elements of the specified block to this block.
+         *
+         * @param other Addend block, or matrix.
+         * @return Block const&
+         * @throw Throws invalid_argument if the two blocks do not have the same dimensions.
+         */
+        Block const& operator+=(ConstBlock const& other) const;
+
+        /**
+         * @brief Subtracts the elements of the specified block from this block.
+         *
+         * @param other Subtrahend block, or matrix.
+         * @return Block const&
+         * @throw Throws invalid_argument if the two blocks do not have the same dimensions.
+         */
+        Block const& operator-=(ConstBlock const& other) const;
+
+        /**
+         * @brief Multiplies every element of this block by the specified scalar value.
+         *
+         * @param s Scalar value.
+         * @return Block const&
+         */
+        Block const& operator*=(double s) const;
+
+        /**
+         * @brief Returns the reference of the element at the specified row and column index of the
+         *        block.
+         *
+         * @param numRow Row index within the block.
+         * @param numCol Column index within the block.
+         * @return double&
+         * @throw Throws out_of_range if the specified row and column is outside the range
+         *        [0, max_row) and [0, max_col) of the block respectively.
+         */
+        double& operator()(int numRow, int numCol) const;
+
+        /**
+         * @brief Returns the size of the block where the first of the pair is the number of rows
+         *        and the second of the pair is the number of columns.
+         *
+         * @return std::pair<int, int>
+         */
+        std::pair<int, int> size() const;
+
+    private:
+        friend class SmallMatrix;
+        friend void multiplyAdd(ConstBlock const& lhs, ConstBlock const& rhs, Block const& out);
+        friend void multiplyAdd(ConstBlock const& lhs, ConstBlock const& rhs, Block const& out, ExecutionPolicy policy);
+
+        Block(SmallMatrix* sm, int firstRow, int firstCol, int numRows, int numCols);
+
+        /**
+         * @brief Returns a pointer to the first element of the specified row of the block. The row
+         *        index is not checked.
+         *
+         * @param numRow Row index within the block.
+         * @return double*
+         */
+        double* rowData(int numRow) const;
+
+        SmallMatrix* mMatrix;
+        int mFirstRow;
+        int mFirstCol;
+        int mNumRows;
+        int mNumCols;
+    };
+
     /**
      * @brief A constructor which initialises an empty matrix with no rows and no columns.
      */
@@ -52,6 +269,14 @@ public:
      */
     SmallMatrix(std::initializer_list<std::initializer_list<double>> const& il);
 
+    /**
+     * @brief A constructor which initialises a matrix with a copy of the elements of the specified
+     *        block.
+     *
+     * @param block Block to copy.
+     */
+    explicit SmallMatrix(ConstBlock const& block);
+
     /**
      * @brief Copy constructor.
      *
@@ -59,6 +284,15 @@ public:
      */
     SmallMatrix(SmallMatrix const& sm);
 
+    /**
+     * @brief Copy constructor which copies the elements of large matrices using the specified
+     *        execution policy.
+     *
+     * @param sm SmallMatrix to make a copy of.
+     * @param policy Execution policy of the copy.
+     */
+    SmallMatrix(SmallMatrix const& sm, ExecutionPolicy policy);
+
     /**
      * @brief Move constructor.
      *
@@ -74,6 +308,16 @@ public:
      */
     SmallMatrix& operator=(SmallMatrix const& sm);
 
+    /**
+     * @brief Copy assignment which copies the elements of large matrices using the specified
+     *        execution policy.
+     *
+     * @param sm SmallMatrix to make a copy of.
+     * @param policy Execution policy of the copy.
+     * @return SmallMatrix&
+     */
+    SmallMatrix& assign(SmallMatrix const& sm, ExecutionPolicy policy);
+
     /**
      * @brief Move assignment.
      *
@@ -152,6 +396,32 @@ public:
      */
     std::vector<double const*> col(int numCol) const;
 
+    /**
+     * @brief Returns a writable view of the block of the matrix starting at the specified row and
+     *        column index with the specified dimensions.
+     *
+     * @param numRow Index of the first row of the block.
+     * @param numCol Index of the first column of the block.
+     * @param numRows Number of rows in the block.
+     * @param numCols Number of columns in the block.
+     * @return Block
+     * @throw Throws out_of_range if the block does not lie within the matrix.
+     */
+    Block block(int numRow, int numCol, int numRows, int numCols);
+
+    /**
+     * @brief Returns a read-only view of the block of the matrix starting at the specified row and
+     *        column index with the specified dimensions.
+     *
+     * @param numRow Index of the first row of the block.
+     * @param numCol Index of the first column of the block.
+     * @param numRows Number of rows in the block.
+     * @param numCols Number of columns in the block.
+     * @return ConstBlock
+     * @throw Throws out_of_range if the block does not lie within the matrix.
+     */
+    ConstBlock block(int numRow, int numCol, int numRows, int numCols) const;
+
     /**
      * @brief Returns the size of the matrix where the first of the pair is the number of rows and
      *        the second of the pair is the number of columns.
@@ -168,6 +438,36 @@ public:
      */
     bool isSmall() const;
 
+    /**
+     * @brief Enables or disables copy-on-write for the heap buffer of the matrix. While enabled,
+     *        copies of a large matrix share one reference-counted buffer, and a copy only makes
+     *        its own buffer on the first mutable access. Small matrices are always copied by value,
+     *        so enabling copy-on-write on one has no effect. Large copies inherit the mode of the
+     *        matrix they were copied from.
+     *
+     *        Thread-safety: distinct matrix objects that share a buffer may be read, copied,
+     *        modified and destroyed from different threads. The owner count is atomic, and a
+     *        matrix only writes to a buffer in place once an acquire load of the count shows it is
+     *        the sole owner, so it never races with reads through a copy released by another
+     *        thread. As with any object, one matrix must not be modified while another thread
+     *        reads or copies that same matrix.
+     *
+     *        A reference or pointer obtained through a mutable access before the matrix is copied
+     *        keeps pointing into the shared buffer, so writing through it also changes every copy
+     *        that still shares the buffer. Obtain it again after copying.
+     *
+     * @param enabled true, to share heap buffers between copies.
+     */
+    void setCopyOnWrite(bool enabled);
+
+    /**
+     * @brief Returns true if copy-on-write is enabled for the matrix.
+     *
+     * @return true, if copies share the heap buffer.
+     * @return false, otherwise.
+     */
+    bool isCopyOnWrite() const;
+
     /**
      * @brief Resizes the matrix to the new number of rows and new number of columns. If any matrix
      *        dimension is increased, then the newly created dimension is zero-initialised. If any
@@ -179,6 +479,17 @@ public:
      */
     void resize(int numRows, int numCols);
 
+    /**
+     * @brief Resizes the matrix as resize(int, int) does, filling the rows of large matrices using
+     *        the specified execution policy.
+     *
+     * @param numRows Number of rows to resize to.
+     * @param numCols Number of columns to resize to.
+     * @param policy Execution policy of the resize.
+     * @throw Throws out_of_range if the specified row or column index is negative.
+     */
+    void resize(int numRows, int numCols, ExecutionPolicy policy);
+
     /**
      * @brief Inserts a row at the specified row index. If the number of columns in the matrix is
      *        zero, then the matrix is resized to match the size of the specified row vector.
@@ -241,6 +552,68 @@ public:
      */
     friend bool operator!=(SmallMatrix const& lhs, SmallMatrix const& rhs);
 
+    /**
+     * @brief Returns true if the two specified matrices are equal as defined by operator==,
+     *        comparing the elements using the specified execution policy.
+     *
+     * @param lhs Left-hand side matrix.
+     * @param rhs Right-hand side matrix.
+     * @param policy Execution policy of the comparison.
+     * @return true, if lhs and rhs are equal.
+     * @return false, otherwise.
+     */
+    friend bool equals(SmallMatrix const& lhs, SmallMatrix const& rhs, ExecutionPolicy policy);
+
+    /**
+     * @brief Returns the element-wise addition of the two specified matrices, computed using the
+     *        specified execution policy.
+     *
+     * @param lhs Left-hand side matrix.
+     * @param rhs Right-hand side matrix.
+     * @param policy Execution policy of the addition.
+     * @return SmallMatrix
+     * @throw Throws invalid_argument if the number of rows and columns on the left-hand side is not
+     *        equal to the number of rows and columns on the right-hand side respectively.
+     */
+    friend SmallMatrix add(SmallMatrix const& lhs, SmallMatrix const& rhs, ExecutionPolicy policy);
+
+    /**
+     * @brief Returns the element-wise subtraction of the two specified matrices, computed using the
+     *        specified execution policy.
+     *
+     * @param lhs Left-hand side matrix.
+     * @param rhs Right-hand side matrix.
+     * @param policy Execution policy of the subtraction.
+     * @return SmallMatrix
+     * @throw Throws invalid_argument if the number of rows and columns on the left-hand side is not
+     *        equal to the number of rows and columns on the right-hand side respectively.
+     */
+    friend SmallMatrix subtract(SmallMatrix const& lhs, SmallMatrix const& rhs, ExecutionPolicy policy);
+
+    /**
+     * @brief Returns the matrix multiplication of the two specified matrices, computed using the
+     *        specified execution policy.
+     *
+     * @param lhs Left-hand side matrix.
+     * @param rhs Right-hand side matrix.
+     * @param policy Execution policy of the multiplication.
+     * @return SmallMatrix
+     * @throw Throws invalid_argument if the number of columns on the left-hand side is not equal to
+     *        the number of rows on the right-hand side.
+     */
+    friend SmallMatrix multiply(SmallMatrix const& lhs, SmallMatrix const& rhs, ExecutionPolicy policy);
+
+    /**
+     * @brief Returns the matrix whose elements are the elements of the specified matrix multiplied
+     *        by the specified scalar, computed using the specified execution policy.
+     *
+     * @param s Scalar.
+     * @param sm SmallMatrix.
+     * @param policy Execution policy of the multiplication.
+     * @return SmallMatrix
+     */
+    friend SmallMatrix multiply(double s, SmallMatrix const& sm, ExecutionPolicy policy);
+
     /**
      * @brief Returns the matrix result of the element-wise addition of the two specified matrices.
      *
@@ -275,6 +648,57 @@ public:
      */
     friend SmallMatrix operator*(SmallMatrix const& lhs, SmallMatrix const& rhs);
 
+    /**
+     * @brief Returns the matrix result of the element-wise addition of the two specified blocks.
+     *
+     * @param lhs Left-hand side block.
+     * @param rhs Right-hand side block.
+     * @return SmallMatrix
+     * @throw Throws invalid_argument if the two blocks do not have the same dimensions.
+     */
+    friend SmallMatrix operator+(ConstBlock const& lhs, ConstBlock const& rhs);
+
+    /**
+     * @brief Returns the matrix result of the element-wise subtraction of the two specified blocks.
+     *
+     * @param lhs Left-hand side block.
+     * @param rhs Right-hand side block.
+     * @return SmallMatrix
+     * @throw Throws invalid_argument if the two blocks do not have the same dimensions.
+     */
+    friend SmallMatrix operator-(ConstBlock const& lhs, ConstBlock const& rhs);
+
+    /**
+     * @brief Returns the matrix result of the matrix multiplication of the two specified blocks.
+     *
+     * @param lhs Left-hand side block.
+     * @param rhs Right-hand side block.
+     * @return SmallMatrix
+     * @throw Throws invalid_argument if the number of columns on the left-hand side is not equal to
+     *        the number of rows on the right-hand side.
+     */
+    friend SmallMatrix operator*(ConstBlock const& lhs, ConstBlock const& rhs);
+
+    /**
+     * @brief Returns the matrix result of the scalar multiplication of the specified scalar value
+     *        and block.
+     *
+     * @param s Scalar value.
+     * @param block Block.
+     * @return SmallMatrix
+     */
+    friend SmallMatrix operator*(double s, ConstBlock const& block);
+
+    /**
+     * @brief Returns the matrix result of the scalar multiplication of the specified block and
+     *        scalar value.
+     *
+     * @param block Block.
+     * @param s Scalar value.
+     * @return SmallMatrix
+     */
+    friend SmallMatrix operator*(ConstBlock const& block, double s);
+
     /**
      * @brief Returns the matrix result of the scalar multiplication of the the specified scalar
      *        value and specified matrix.
@@ -295,6 +719,96 @@ public:
      */
     friend SmallMatrix operator*(SmallMatrix const& sm, double s);
 
+    /**
+     * @brief Returns the matrix-vector product of the specified matrix and column vector.
+     *
+     * @param sm SmallMatrix.
+     * @param x Column vector with one element per column of the matrix.
+     * @return std::vector<double>
+     * @throw Throws invalid_argument if the size of the vector is not equal to the number of
+     *        columns in the matrix.
+     */
+    friend std::vector<double> operator*(SmallMatrix const& sm, std::vector<double> const& x);
+
+    /**
+     * @brief Writes the matrix-vector product of the specified matrix and column vector to out,
+     *        which is resized to the number of rows. The storage of out is reused, so repeated
+     *        products into the same vector do not allocate.
+     *
+     * @param sm SmallMatrix.
+     * @param x Column vector with one element per column of the matrix.
+     * @param out Vector for the result. Must not be x.
+     * @throw Throws invalid_argument if the size of the vector is not equal to the number of
+     *        columns in the matrix, or if out is x.
+     */
+    friend void multiply(SmallMatrix const& sm, std::vector<double> const& x, std::vector<double>& out);
+
+    /**
+     * @brief Returns the product of the transpose of the specified matrix and the column vector,
+     *        without forming the transpose.
+     *
+     * @param sm SmallMatrix.
+     * @param x Column vector with one element per row of the matrix.
+     * @return std::vector<double>
+     * @throw Throws invalid_argument if the size of the vector is not equal to the number of rows
+     *        in the matrix.
+     */
+    friend std::vector<double> multiplyTransposed(SmallMatrix const& sm, std::vector<double> const& x);
+
+    /**
+     * @brief Writes the product of the transpose of the specified matrix and the column vector to
+     *        out, which is resized to the number of columns. The storage of out is reused.
+     *
+     * @param sm SmallMatrix.
+     * @param x Column vector with one element per row of the matrix.
+     * @param out Vector for the result. Must not be x.
+     * @throw Throws invalid_argument if the size of the vector is not equal to the number of rows
+     *        in the matrix, or if out is x.
+     */
+    friend void multiplyTransposed(SmallMatrix const& sm, std::vector<double> const& x, std::vector<double>& out);
+
+    /**
+     * @brief Returns the outer product x * y^T of the two specified vectors.
+     *
+     * @param x Column vector, giving the number of rows.
+     * @param y Row vector, giving the number of columns.
+     * @return SmallMatrix
+     */
+    friend SmallMatrix outerProduct(std::vector<double> const& x, std::vector<double> const& y);
+
+    /**
+     * @brief Adds the scaled outer product alpha * x * y^T to *this.
+     *
+     * @param alpha Scalar value.
+     * @param x Column vector with one element per row of the matrix.
+     * @param y Row vector with one element per column of the matrix.
+     * @throw Throws invalid_argument if the size of x is not equal to the number of rows or the
+     *        size of y is not equal to the number of columns in the matrix.
+     */
+    void addOuterProduct(double alpha, std::vector<double> const& x, std::vector<double> const& y);
+
+    /**
+     * @brief Multiplies the matrix by each of a packed array of points. Point p is read from
+     *        points[p * cols .. (p + 1) * cols) and its result is written to
+     *        results[p * rows .. (p + 1) * rows). Large batches are split across threads.
+     *
+     * @param points Packed input points, numPoints * cols elements.
+     * @param results Packed output points, numPoints * rows elements. Must not overlap points.
+     * @param numPoints Number of points.
+     * @throw Throws invalid_argument if numPoints is negative.
+     */
+    void transformPoints(double const* points, double* results, int numPoints) const;
+
+    /**
+     * @brief Returns the result of multiplying the matrix by each of a packed array of points.
+     *
+     * @param points Packed input points, each with one element per column of the matrix.
+     * @return std::vector<double>
+     * @throw Throws invalid_argument if the number of elements is not a multiple of the number of
+     *        columns in the matrix.
+     */
+    std::vector<double> transformPoints(std::vector<double> const& points) const;
+
     /**
      * @brief Returns *this after the element-wise addition of *this and the specified matrix. This
      *        operation is equivalent to *this = *this + sm.
@@ -306,6 +820,17 @@ public:
      */
     SmallMatrix& operator+=(SmallMatrix const& sm);
 
+    /**
+     * @brief Returns the result of operator+=, computed using the specified execution policy.
+     *
+     * @param sm Addend matrix.
+     * @param policy Execution policy of the addition.
+     * @return SmallMatrix&
+     * @throw Throws invalid_argument if the number of rows and columns of *this is not equal to the
+     *        number of rows and columns of the specified matrix respectively.
+     */
+    SmallMatrix& addAssign(SmallMatrix const& sm, ExecutionPolicy policy);
+
     /**
      * @brief Returns *this after the element-wise subtraction of *this and the specified matrix.
      *        This operation is equivalent to *this = *this - sm.
@@ -317,6 +842,17 @@ public:
      */
     SmallMatrix& operator-=(SmallMatrix const& sm);
 
+    /**
+     * @brief Returns the result of operator-=, computed using the specified execution policy.
+     *
+     * @param sm Subtrahend matrix.
+     * @param policy Execution policy of the subtraction.
+     * @return SmallMatrix&
+     * @throw Throws invalid_argument if the number of rows and columns of *this is not equal to the
+     *        number of rows and columns of the specified matrix respectively.
+     */
+    SmallMatrix& subtractAssign(SmallMatrix const& sm, ExecutionPolicy policy);
+
     /**
      * @brief Returns *this after the matrix multiplication of *this and the specified matrix. This
      *        operation is equivalent to *this = *this * sm.
@@ -328,6 +864,18 @@ public:
      */
     SmallMatrix& operator*=(SmallMatrix const& sm);
 
+    /**
+     * @brief Returns the result of operator*= on a matrix, computed using the specified execution
+     *        policy.
+     *
+     * @param sm Multiplier matrix.
+     * @param policy Execution policy of the multiplication.
+     * @return SmallMatrix&
+     * @throw Throws invalid_argument if the number of columns of *this is not equal to the number
+     *        of rows of the specified matrix.
+     */
+    SmallMatrix& multiplyAssign(SmallMatrix const& sm, ExecutionPolicy policy);
+
     /**
      * @brief Returns *this after the scalar multiplication of *this and the specified scalar value.
      *        This operation is equivalent to *this = *this * s.
@@ -337,6 +885,16 @@ public:
      */
     SmallMatrix& operator*=(double s);
 
+    /**
+     * @brief Returns the result of operator*= on a scalar value, computed using the specified
+     *        execution policy.
+     *
+     * @param s Scalar value.
+     * @param policy Execution policy of the multiplication.
+     * @return SmallMatrix&
+     */
+    SmallMatrix& multiplyAssign(double s, ExecutionPolicy policy);
+
     /**
      * @brief Returns the result of the tranpose on the specified matrix.
      *
@@ -345,6 +903,249 @@ public:
      */
     friend SmallMatrix transpose(SmallMatrix const& sm);
 
+    /**
+     * @brief Returns the transpose of the specified matrix, computed using the specified execution
+     *        policy.
+     *
+     * @param sm SmallMatrix.
+     * @param policy Execution policy of the transpose.
+     * @return SmallMatrix
+     */
+    friend SmallMatrix transpose(SmallMatrix const& sm, ExecutionPolicy policy);
+
+    /**
+     * @brief Accumulates the matrix multiplication of the two specified matrices into the output
+     *        matrix i.e. out += lhs * rhs. No memory is allocated, so a caller can reuse the same
+     *        output matrix across many products.
+     *
+     * @param lhs Left-hand side matrix.
+     * @param rhs Right-hand side matrix.
+     * @param out Output matrix, which must already have lhs's rows and rhs's columns.
+     * @throw Throws invalid_argument if the number of columns on the left-hand side is not equal to
+     *        the number of rows on the right-hand side, or if out has the wrong dimensions.
+     * @throw Throws invalid_argument if out is the same object as lhs or rhs.
+     */
+    friend void multiplyAdd(SmallMatrix const& lhs, SmallMatrix const& rhs, SmallMatrix& out);
+
+    /**
+     * @brief Accumulates the matrix multiplication of the two specified matrices into the output
+     *        matrix as multiplyAdd(lhs, rhs, out) does, using the specified execution policy.
+     *
+     * @param lhs Left-hand side matrix.
+     * @param rhs Right-hand side matrix.
+     * @param out Output matrix, which must already have lhs's rows and rhs's columns.
+     * @param policy Execution policy of the multiplication.
+     * @throw Throws invalid_argument if the number of columns on the left-hand side is not equal to
+     *        the number of rows on the right-hand side, or if out has the wrong dimensions.
+     * @throw Throws invalid_argument if out is the same object as lhs or rhs.
+     */
+    friend void multiplyAdd(SmallMatrix const& lhs, SmallMatrix const& rhs, SmallMatrix& out, ExecutionPolicy policy);
+
+    /**
+     * @brief Accumulates the matrix multiplication of the two specified blocks into the output
+     *        block i.e. out += lhs * rhs, writing straight into the matrix the output block views.
+     *
+     * @param lhs Left-hand side block.
+     * @param rhs Right-hand side block.
+     * @param out Output block, which must already have lhs's rows and rhs's columns.
+     * @throw Throws invalid_argument if the number of columns on the left-hand side is not equal to
+     *        the number of rows on the right-hand side, or if out has the wrong dimensions.
+     * @throw Throws invalid_argument if out overlaps lhs or rhs.
+     */
+    friend void multiplyAdd(ConstBlock const& lhs, ConstBlock const& rhs, Block const& out);
+
+    /**
+     * @brief Accumulates the matrix multiplication of the two specified blocks into the output
+     *        block as multiplyAdd(lhs, rhs, out) does, using the specified execution policy. Rows
+     *        of the output are split between threads, so every element is computed in the same
+     *        order whatever the policy.
+     *
+     * @param lhs Left-hand side block.
+     * @param rhs Right-hand side block.
+     * @param out Output block, which must already have lhs's rows and rhs's columns.
+     * @param policy Execution policy of the multiplication.
+     * @throw Throws invalid_argument if the number of columns on the left-hand side is not equal to
+     *        the number of rows on the right-hand side, or if out has the wrong dimensions.
+     * @throw Throws invalid_argument if out overlaps lhs or rhs.
+     */
+    friend void multiplyAdd(ConstBlock const& lhs, ConstBlock const& rhs, Block const& out, ExecutionPolicy policy);
+
+    /**
+     * @brief Returns the result of the transpose on the specified block.
+     *
+     * @param block Block to be transposed.
+     * @return SmallMatrix
+     */
+    friend SmallMatrix transpose(ConstBlock const& block);
+
+    /**
+     * @brief Returns the result of the transpose on the specified block, computed using the
+     *        specified execution policy.
+     *
+     * @param block Block to be transposed.
+     * @param policy Execution policy of the transpose.
+     * @return SmallMatrix
+     */
+    friend SmallMatrix transpose(ConstBlock const& block, ExecutionPolicy policy);
+
+    /**
+     * @brief Returns the product of a chain of matrices, e.g. A * B * C * D. The order in which
+     *        the products are evaluated is chosen by dynamic programming so that the total number
+     *        of scalar multiplications is minimised.
+     *
+     * @param chain Matrices to be multiplied, from left to right.
+     * @return SmallMatrix
+     * @throw Throws invalid_argument if the chain is empty.
+     * @throw Throws invalid_argument if the number of columns of any matrix is not equal to the
+     *        number of rows of the matrix that follows it.
+     */
+    friend SmallMatrix multiplyChain(
+        std::vector<std::reference_wrapper<SmallMatrix const>> const& chain);
+
+    /**
+     * @brief Returns the specified square matrix raised to the power n, computed by binary
+     *        exponentiation. Only three temporary matrices are allocated regardless of n. A power
+     *        of zero returns the identity matrix.
+     *
+     * @param sm Square matrix.
+     * @param n Non-negative exponent.
+     * @return SmallMatrix
+     * @throw Throws invalid_argument if the matrix is not square.
+     * @throw Throws invalid_argument if n is negative.
+     */
+    friend SmallMatrix pow(SmallMatrix const& sm, int n);
+
+    /**
+     * @brief Returns the solution X of the linear system lhs * X = rhs, computed by Gaussian
+     *        elimination with partial pivoting. Each column of rhs is a separate right-hand side.
+     *
+     * @param lhs Square coefficient matrix.
+     * @param rhs Right-hand side matrix.
+     * @return SmallMatrix
+     * @throw Throws invalid_argument if the left-hand side is not square.
+     * @throw Throws invalid_argument if the number of rows on the left-hand side is not equal to
+     *        the number of rows on the right-hand side.
+     * @throw Throws invalid_argument if the left-hand side is singular.
+     */
+    friend SmallMatrix solve(SmallMatrix const& lhs, SmallMatrix const& rhs);
+
+    /**
+     * @brief Returns the sum of all of the elements of the matrix. Rows are summed pairwise and the
+     *        partial sums are combined with compensated summation, so the result does not depend
+     *        on the number of threads used.
+     *
+     * @param policy Execution policy of the reduction.
+     * @return double
+     */
+    double sum(ExecutionPolicy policy = ExecutionPolicy::Parallel) const;
+
+    /**
+     * @brief Returns the sum of the elements on the main diagonal of the matrix.
+     *
+     * @return double
+     * @throw Throws invalid_argument if the matrix is not square.
+     */
+    double trace() const;
+
+    /**
+     * @brief Returns the Frobenius norm of the matrix i.e. the square root of the sum of the
+     *        squares of all of the elements.
+     *
+     * @param policy Execution policy of the reduction.
+     * @return double
+     */
+    double frobeniusNorm(ExecutionPolicy policy = ExecutionPolicy::Parallel) const;
+
+    /**
+     * @brief Returns the infinity norm of the matrix i.e. the largest sum of the absolute values of
+     *        the elements of a row.
+     *
+     * @param policy Execution policy of the reduction.
+     * @return double
+     */
+    double infinityNorm(ExecutionPolicy policy = ExecutionPolicy::Parallel) const;
+
+    /**
+     * @brief Returns the smallest element of the matrix.
+     *
+     * @param policy Execution policy of the reduction.
+     * @return double
+     * @throw Throws out_of_range if the matrix has no elements.
+     */
+    double min(ExecutionPolicy policy = ExecutionPolicy::Parallel) const;
+
+    /**
+     * @brief Returns the largest element of the matrix.
+     *
+     * @param policy Execution policy of the reduction.
+     * @return double
+     * @throw Throws out_of_range if the matrix has no elements.
+     */
+    double max(ExecutionPolicy policy = ExecutionPolicy::Parallel) const;
+
+    /**
+     * @brief Returns the row and column index of the smallest element of the matrix. Ties are
+     *        broken by the first element in row-major order.
+     *
+     * @param policy Execution policy of the reduction.
+     * @return std::pair<int, int>
+     * @throw Throws out_of_range if the matrix has no elements.
+     */
+    std::pair<int, int> argMin(ExecutionPolicy policy = ExecutionPolicy::Parallel) const;
+
+    /**
+     * @brief Returns the row and column index of the largest element of the matrix. Ties are
+     *        broken by the first element in row-major order.
+     *
+     * @param policy Execution policy of the reduction.
+     * @return std::pair<int, int>
+     * @throw Throws out_of_range if the matrix has no elements.
+     */
+    std::pair<int, int> argMax(ExecutionPolicy policy = ExecutionPolicy::Parallel) const;
+
+    /**
+     * @brief Returns the matrix whose elements are the result of applying the specified function
+     *        to each positionally-corresponding element of *this. Large matrices are processed by
+     *        several threads, so the function must be safe to call concurrently.
+     *
+     * @param f Function taking and returning a double.
+     * @param policy Execution policy of the map.
+     * @return SmallMatrix
+     */
+    template <typename UnaryFunction>
+    SmallMatrix map(UnaryFunction f, ExecutionPolicy policy = ExecutionPolicy::Parallel) const;
+
+    /**
+     * @brief Returns the matrix whose elements are the result of applying the specified function
+     *        to each pair of positionally-corresponding elements of the two specified matrices.
+     *        Large matrices are processed by several threads, so the function must be safe to call
+     *        concurrently.
+     *
+     * @param lhs Left-hand side matrix.
+     * @param rhs Right-hand side matrix.
+     * @param f Function taking two doubles and returning a double.
+     * @return SmallMatrix
+     * @throw Throws invalid_argument if the number of rows and columns on the left-hand side is not
+     *        equal to the number of rows and columns on the right-hand side respectively.
+     */
+    template <typename BinaryFunction>
+    friend SmallMatrix zip(SmallMatrix const& lhs, SmallMatrix const& rhs, BinaryFunction f);
+
+    /**
+     * @brief Returns the matrix zip(lhs, rhs, f) returns, computed using the specified execution
+     *        policy.
+     *
+     * @param lhs Left-hand side matrix.
+     * @param rhs Right-hand side matrix.
+     * @param f Function taking two doubles and returning a double.
+     * @param policy Execution policy of the zip.
+     * @return SmallMatrix
+     * @throw Throws invalid_argument if the number of rows and columns on the left-hand side is not
+     *        equal to the number of rows and columns on the right-hand side respectively.
+     */
+    template <typename BinaryFunction>
+    friend SmallMatrix zip(SmallMatrix const& lhs, SmallMatrix const& rhs, BinaryFunction f, ExecutionPolicy policy);
+
     /**
      * @brief Writes the contents of the matrix to the output stream.
      *
@@ -355,15 +1156,276 @@ public:
     friend std::ostream& operator<<(std::ostream& os, SmallMatrix const& sm);
 
 private:
+    friend class TiledMatrix;
+    friend class Tuner;
+    friend double* detail::rowData(SmallMatrix& sm, int numRow);
+    friend double const* detail::rowData(SmallMatrix const& sm, int numRow);
+
+    /**
+     * @brief Returns a pointer to the first element of the specified row. The row index is not
+     *        checked.
+     *
+     * @param numRow Row index.
+     * @return double*
+     */
+    double* rowData(int numRow);
+
+    /**
+     * @brief Returns a pointer to the first element of constant type of the specified row. The row
+     *        index is not checked.
+     *
+     * @param numRow Row index.
+     * @return double const*
+     */
+    double const* rowData(int numRow) const;
+
+    /**
+     * @brief Returns the heap buffer holding the elements of a large matrix, which is shared when
+     *        copy-on-write is enabled.
+     *
+     * @return std::vector<std::vector<double>> const&
+     */
+    std::vector<std::vector<double>> const& heapData() const;
+
+    /**
+     * @brief Returns the heap buffer holding the elements of a large matrix for modification. A
+     *        shared copy-on-write buffer is copied first if any other matrix still refers to it.
+     *
+     * @return std::vector<std::vector<double>>&
+     */
+    std::vector<std::vector<double>>& mutableHeapData();
+
+    /**
+     * @brief Overwrites out with the matrix multiplication of lhs and rhs. The dimensions of out
+     *        must already match the product and out must not alias either operand.
+     *
+     * @param lhs Left-hand side matrix.
+     * @param rhs Right-hand side matrix.
+     * @param out Output matrix.
+     * @param policy Execution policy of the multiplication.
+     */
+    static void multiplyInto(SmallMatrix const& lhs, SmallMatrix const& rhs, SmallMatrix& out,
+                             ExecutionPolicy policy = ExecutionPolicy::Parallel);
+
+    /**
+     * @brief Accumulates lhs * rhs into out with the specified kernel and block size. The
+     *        dimensions must already match and out must not overlap either operand.
+     *
+     * @param lhs Left-hand side block.
+     * @param rhs Right-hand side block.
+     * @param out Output block.
+     * @param blockSize Number of rows and columns of the right-hand side kept in cache together.
+     * @param kernel Inner kernel.
+     * @param parallel true, to split the rows of the output across threads.
+     */
+    static void multiplyKernel(ConstBlock const& lhs, ConstBlock const& rhs, Block const& out,
+                               int blockSize, MultiplyKernel kernel, bool parallel);
+
+    /**
+     * @brief Writes the transpose of the block into out, one square tile at a time. out must
+     *        already have the block's columns as rows and the block's rows as columns.
+     *
+     * @param block Block to be transposed.
+     * @param out Output matrix.
+     * @param tileSize Number of rows and columns of a tile.
+     * @param parallel true, to split the columns of tiles across threads.
+     */
+    static void transposeKernel(ConstBlock const& block, SmallMatrix& out, int tileSize, bool parallel);
+
+    /**
+     * @brief Writes the product of a chain of at least two matrices into out, following the split
+     *        points chosen by multiplyChain. Intermediate products are held in heap buffers that
+     *        are reused once consumed.
+     *
+     * @param chain Matrices to be multiplied.
+     * @param split Split point table, indexed by first * chain.size() + last.
+     * @param out Output matrix.
+     */
+    static void multiplyChainInto(
+        std::vector<std::reference_wrapper<SmallMatrix const>> const& chain,
+        std::vector<int> const& split, SmallMatrix& out);
+
+    /**
+     * @brief Returns the number of rows processed together by one task of a bulk operation. It
+     *        only depends on the number of columns, so results never depend on the thread count.
+     *
+     * @return int
+     */
+    int rowsPerChunk() const;
+
+    /**
+     * @brief Returns true if a bulk operation on the matrix should be split across threads under
+     *        the specified execution policy.
+     *
+     * @param policy Execution policy of the operation.
+     * @param parallelThreshold Number of elements from which the Parallel policy uses threads.
+     * @return true, if policy is ThreadPool, or policy is Parallel and the matrix has at least
+     *         parallelThreshold elements.
+     * @return false, otherwise.
+     */
+    bool isParallelSized(ExecutionPolicy policy, int parallelThreshold) const;
+
+    /**
+     * @brief Calls rowFunction(firstRow, lastRow) for consecutive chunks of rowsPerChunk() rows,
+     *        using several threads if isParallelSized(policy, parallelThreshold) is true.
+     *
+     * @param rowFunction Function processing the rows in [firstRow, lastRow).
+     * @param policy Execution policy of the operation.
+     * @param parallelThreshold Number of elements from which the Parallel policy uses threads.
+     */
+    void forEachRowChunk(std::function<void(int, int)> const& rowFunction,
+                         ExecutionPolicy policy = ExecutionPolicy::Parallel,
+                         int parallelThreshold = Tuner::parameters().parallelThreshold) const;
+
+    /**
+     * @brief Resizes every row of the heap data to mNumRows rows of mNumCols columns, zero-filling
+     *        the new elements.
+     *
+     * @param policy Execution policy of the zero-fill.
+     */
+    void resizeHeapRows(ExecutionPolicy policy);
+
+    /**
+     * @brief A reference-counted heap buffer shared by copy-on-write copies of a matrix. Copying
+     *        the handle shares the buffer. Unlike std::shared_ptr::use_count, isUnique() is
+     *        ordered after every other owner has released the buffer, so a writer that sees it
+     *        is the only owner cannot race with the reads of an owner that has just gone away.
+     */
+    class SharedHeapData {
+    public:
+        SharedHeapData() = default;
+
+        /**
+         * @brief A constructor which moves the specified rows into a new buffer with one owner.
+         *
+         * @param rows Rows of the buffer.
+         */
+        explicit SharedHeapData(std::vector<std::vector<double>> rows);
+
+        SharedHeapData(SharedHeapData const& other) noexcept;
+        SharedHeapData(SharedHeapData&& other) noexcept;
+        SharedHeapData& operator=(SharedHeapData other) noexcept;
+        ~SharedHeapData();
+
+        /**
+         * @brief Returns true if the handle refers to a buffer.
+         */
+        explicit operator bool() const;
+
+        /**
+         * @brief Returns the rows of the buffer. The handle must refer to a buffer.
+         *
+         * @return std::vector<std::vector<double>>&
+         */
+        std::vector<std::vector<double>>& operator*() const;
+
+        /**
+         * @brief Returns true if this handle is the only owner of its buffer.
+         *
+         * @return true, if no other matrix shares the buffer.
+         * @return false, otherwise.
+         */
+        bool isUnique() const;
+
+        /**
+         * @brief Releases the buffer, leaving the handle empty.
+         */
+        void reset();
+
+    private:
+        struct Buffer {
+            std::vector<std::vector<double>> rows;
+            std::atomic<long> numOwners {1};
+        };
+
+        Buffer* mBuffer {nullptr};
+    };
+
     int mNumRows;
     int mNumCols;
     bool mIsLargeMatrix;
     static constexpr int mSmallSize = 144;
+    static constexpr int mChunkSize = 1 << 14;
     std::array<std::array<double, mSmallSize>, mSmallSize> mStackData;
     std::vector<std::vector<double>> mHeapData;
+    SharedHeapData mSharedHeapData;
 };
 
 // Forward declaring.
 SmallMatrix transpose(SmallMatrix const&);
+SmallMatrix transpose(SmallMatrix const&, ExecutionPolicy);
+void multiplyAdd(SmallMatrix const&, SmallMatrix const&, SmallMatrix&);
+void multiplyAdd(SmallMatrix const&, SmallMatrix const&, SmallMatrix&, ExecutionPolicy);
+void multiplyAdd(SmallMatrix::ConstBlock const&, SmallMatrix::ConstBlock const&, SmallMatrix::Block const&);
+void multiplyAdd(SmallMatrix::ConstBlock const&, SmallMatrix::ConstBlock const&, SmallMatrix::Block const&, ExecutionPolicy);
+SmallMatrix transpose(SmallMatrix::ConstBlock const&);
+SmallMatrix transpose(SmallMatrix::ConstBlock const&, ExecutionPolicy);
+bool equals(SmallMatrix const&, SmallMatrix const&, ExecutionPolicy);
+SmallMatrix add(SmallMatrix const&, SmallMatrix const&, ExecutionPolicy);
+SmallMatrix subtract(SmallMatrix const&, SmallMatrix const&, ExecutionPolicy);
+SmallMatrix multiply(SmallMatrix const&, SmallMatrix const&, ExecutionPolicy);
+SmallMatrix multiply(double, SmallMatrix const&, ExecutionPolicy);
+SmallMatrix multiplyChain(std::vector<std::reference_wrapper<SmallMatrix const>> const&);
+SmallMatrix pow(SmallMatrix const&, int);
+SmallMatrix solve(SmallMatrix const&, SmallMatrix const&);
+std::vector<double> multiplyTransposed(SmallMatrix const&, std::vector<double> const&);
+void multiply(SmallMatrix const&, std::vector<double> const&, std::vector<double>&);
+void multiplyTransposed(SmallMatrix const&, std::vector<double> const&, std::vector<double>&);
+SmallMatrix outerProduct(std::vector<double> const&, std::vector<double> const&);
+
+namespace detail {
+
+/**
+ * @brief Calls task(i) for every i in [0, numTasks). If parallel is true, the tasks are shared
+ *        between the calling thread and the workers of the library's executor. The first exception
+ *        thrown by a task is rethrown once every claimed task has finished.
+ *
+ * @param numTasks Number of tasks.
+ * @param task Function to call with each task index.
+ * @param parallel true, to use several threads.
+ */
+void parallelFor(int numTasks, std::function<void(int)> const& task, bool parallel);
+
+}  // namespace detail
+
+template <typename UnaryFunction>
+SmallMatrix SmallMatrix::map(UnaryFunction f, ExecutionPolicy policy) const {
+    SmallMatrix newSmallMatrix = SmallMatrix(mNumRows, mNumCols);
+    forEachRowChunk([&](int firstRow, int lastRow) {
+        for (int i {firstRow}; i < lastRow; i++) {
+            double const* row = rowData(i);
+            double* newRow = newSmallMatrix.rowData(i);
+            for (int j {}; j < mNumCols; j++) {
+                newRow[j] = f(row[j]);
+            }
+        }
+    }, policy);
+    return newSmallMatrix;
+}
+
+template <typename BinaryFunction>
+SmallMatrix zip(SmallMatrix const& lhs, SmallMatrix const& rhs, BinaryFunction f) {
+    return zip(lhs, rhs, f, ExecutionPolicy::Parallel);
+}
+
+template <typename BinaryFunction>
+SmallMatrix zip(SmallMatrix const& lhs, SmallMatrix const& rhs, BinaryFunction f, ExecutionPolicy policy) {
+    if (lhs.mNumRows != rhs.mNumRows || lhs.mNumCols != rhs.mNumCols) {
+        throw std::invalid_argument("Unequal dimensions!");
+    }
+
+    SmallMatrix newSmallMatrix = SmallMatrix(lhs.mNumRows, lhs.mNumCols);
+    lhs.forEachRowChunk([&](int firstRow, int lastRow) {
+        for (int i {firstRow}; i < lastRow; i++) {
+            double const* lhsRow = lhs.rowData(i);
+            double const* rhsRow = rhs.rowData(i);
+            double* newRow = newSmallMatrix.rowData(i);
+            for (int j {}; j < lhs.mNumCols; j++) {
+                newRow[j] = f(lhsRow[j], rhsRow[j]);
+            }
+        }
+    }, policy);
+    return newSmallMatrix;
+}
 
 }  // namespace smallMatrix
@@ -0,0 +1,592 @@
+/*
+Structured matrix types for the Small Matrix program.
+*/
+
+#include "StructuredMatrix.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+namespace smallMatrix {
+
+namespace {
+
+// Checks that the right-hand side of a structured product or solve has one row per row of the
+// structured matrix
+void checkOperandRows(int size, SmallMatrix const& sm) {
+    if (sm.size().first != size) {
+        throw std::invalid_argument("Unequal dimensions!");
+    }
+}
+
+}  // namespace
+
+
+DiagonalMatrix::DiagonalMatrix(int size) {
+    if (size < 0) {
+        throw std::out_of_range("Out of Range! Illegal size");
+    }
+    mDiagonal.assign(size, 0.0);
+}
+
+DiagonalMatrix::DiagonalMatrix(std::vector<double> diagonal)
+    :   mDiagonal {std::move(diagonal)} {}
+
+DiagonalMatrix::DiagonalMatrix(SmallMatrix const& sm) {
+    if (sm.size().first != sm.size().second) {
+        throw std::invalid_argument("Matrix is not square!");
+    }
+    mDiagonal.resize(sm.size().first);
+    for (int i {}; i < static_cast<int>(mDiagonal.size()); i++) {
+        mDiagonal.at(i) = detail::rowData(sm, i)[i];
+    }
+}
+
+SmallMatrix DiagonalMatrix::toSmallMatrix() const {
+    const int size = mDiagonal.size();
+    SmallMatrix sm = SmallMatrix(size, size, 0.0);
+    for (int i {}; i < size; i++) {
+        detail::rowData(sm, i)[i] = mDiagonal.at(i);
+    }
+    return sm;
+}
+
+double DiagonalMatrix::operator()(int numRow, int numCol) const {
+    const int size = mDiagonal.size();
+    if (numRow >= size || numCol >= size || numRow < 0 || numCol < 0) {
+        throw std::out_of_range("Out Of Range!");
+    }
+    return numRow == numCol ? mDiagonal.at(numRow) : 0.0;
+}
+
+double& DiagonalMatrix::diagonal(int index) {
+    if (index >= static_cast<int>(mDiagonal.size()) || index < 0) {
+        throw std::out_of_range("Out Of Range!");
+    }
+    return mDiagonal.at(index);
+}
+
+std::pair<int, int> DiagonalMatrix::size() const {
+    return {std::make_pair(mDiagonal.size(), mDiagonal.size())};
+}
+
+SmallMatrix operator*(DiagonalMatrix const& lhs, SmallMatrix const& rhs) {
+    checkOperandRows(lhs.mDiagonal.size(), rhs);
+    SmallMatrix newSmallMatrix = rhs;
+    const int cols = rhs.size().second;
+    for (int i {}; i < static_cast<int>(lhs.mDiagonal.size()); i++) {
+        double* row = detail::rowData(newSmallMatrix, i);
+        const double scalar = lhs.mDiagonal[i];
+        for (int j {}; j < cols; j++) {
+            row[j] *= scalar;
+        }
+    }
+    return newSmallMatrix;
+}
+
+SmallMatrix operator*(SmallMatrix const& lhs, DiagonalMatrix const& rhs) {
+    if (lhs.size().second != static_cast<int>(rhs.mDiagonal.size())) {
+        throw std::invalid_argument("Unequal dimensions!");
+    }
+    SmallMatrix newSmallMatrix = lhs;
+    const int cols = rhs.mDiagonal.size();
+    double const* scalars = rhs.mDiagonal.data();
+    for (int i {}; i < lhs.size().first; i++) {
+        double* row = detail::rowData(newSmallMatrix, i);
+        for (int j {}; j < cols; j++) {
+            row[j] *= scalars[j];
+        }
+    }
+    return newSmallMatrix;
+}
+
+DiagonalMatrix operator*(DiagonalMatrix const& lhs, DiagonalMatrix const& rhs) {
+    if (lhs.mDiagonal.size() != rhs.mDiagonal.size()) {
+        throw std::invalid_argument("Unequal dimensions!");
+    }
+    std::vector<double> diagonal(lhs.mDiagonal.size());
+    std::transform(lhs.mDiagonal.cbegin(), lhs.mDiagonal.cend(), rhs.mDiagonal.cbegin(), diagonal.begin(),
+                   [](double a, double b) { return a * b; });
+    return DiagonalMatrix(std::move(diagonal));
+}
+
+std::vector<double> operator*(DiagonalMatrix const& lhs, std::vector<double> const& x) {
+    if (lhs.mDiagonal.size() != x.size()) {
+        throw std::invalid_argument("Unequal dimensions!");
+    }
+    std::vector<double> y(x.size());
+    std::transform(lhs.mDiagonal.cbegin(), lhs.mDiagonal.cend(), x.cbegin(), y.begin(),
+                   [](double a, double b) { return a * b; });
+    return y;
+}
+
+SmallMatrix solve(DiagonalMatrix const& lhs, SmallMatrix const& rhs) {
+    checkOperandRows(lhs.mDiagonal.size(), rhs);
+    if (std::find(lhs.mDiagonal.cbegin(), lhs.mDiagonal.cend(), 0.0) != lhs.mDiagonal.cend()) {
+        throw std::invalid_argument("Singular matrix!");
+    }
+    SmallMatrix solution = rhs;
+    const int cols = rhs.size().second;
+    for (int i {}; i < static_cast<int>(lhs.mDiagonal.size()); i++) {
+        double* row = detail::rowData(solution, i);
+        const double divisor = lhs.mDiagonal[i];
+        for (int j {}; j < cols; j++) {
+            row[j] /= divisor;
+        }
+    }
+    return solution;
+}
+
+DiagonalMatrix transpose(DiagonalMatrix const& dm) {
+    return dm;
+}
+
+TriangularMatrix::TriangularMatrix(int size, Triangle triangle)
+    :   mSize {size},
+        mTriangle {triangle} {
+    if (size < 0) {
+        throw std::out_of_range("Out of Range! Illegal size");
+    }
+    mPackedData.assign(static_cast<std::size_t>(size) * (size + 1) / 2, 0.0);
+}
+
+TriangularMatrix::TriangularMatrix(SmallMatrix const& sm, Triangle triangle)
+    :   TriangularMatrix(sm.size().first, triangle) {
+    if (sm.size().first != sm.size().second) {
+        throw std::invalid_argument("Matrix is not square!");
+    }
+    for (int i {}; i < mSize; i++) {
+        double const* row = detail::rowData(sm, i);
+        const int firstCol = mTriangle == Triangle::Lower ? 0 : i;
+        const int lastCol = mTriangle == Triangle::Lower ? i + 1 : mSize;
+        std::copy(row + firstCol, row + lastCol, mPackedData.begin() + packedIndex(i, firstCol));
+    }
+}
+
+SmallMatrix TriangularMatrix::toSmallMatrix() const {
+    SmallMatrix sm = SmallMatrix(mSize, mSize, 0.0);
+    for (int i {}; i < mSize; i++) {
+        const int firstCol = mTriangle == Triangle::Lower ? 0 : i;
+        const int lastCol = mTriangle == Triangle::Lower ? i + 1 : mSize;
+        auto const first = mPackedData.cbegin() + packedIndex(i, firstCol);
+        std::copy(first, first + (lastCol - firstCol), detail::rowData(sm, i) + firstCol);
+    }
+    return sm;
+}
+
+double TriangularMatrix::operator()(int numRow, int numCol) const {
+    if (numRow >= mSize || numCol >= mSize || numRow < 0 || numCol < 0) {
+        throw std::out_of_range("Out Of Range!");
+    }
+    return isStored(numRow, numCol) ? mPackedData.at(packedIndex(numRow, numCol)) : 0.0;
+}
+
+double& TriangularMatrix::operator()(int numRow, int numCol) {
+    if (numRow >= mSize || numCol >= mSize || numRow < 0 || numCol < 0 || !isStored(numRow, numCol)) {
+        throw std::out_of_range("Out Of Range!");
+    }
+    return mPackedData.at(packedIndex(numRow, numCol));
+}
+
+std::pair<int, int> TriangularMatrix::size() const { return {std::make_pair(mSize, mSize)}; }
+
+Triangle TriangularMatrix::triangle() const { return mTriangle; }
+
+int TriangularMatrix::packedIndex(int numRow, int numCol) const {
+    // Rows are packed one after another, each holding only its part of the triangle
+    if (mTriangle == Triangle::Lower) {
+        return numRow * (numRow + 1) / 2 + numCol;
+    }
+    return numRow * mSize - numRow * (numRow - 1) / 2 + (numCol - numRow);
+}
+
+bool TriangularMatrix::isStored(int numRow, int numCol) const {
+    return mTriangle == Triangle::Lower ? numCol <= numRow : numCol >= numRow;
+}
+
+SmallMatrix operator*(TriangularMatrix const& lhs, SmallMatrix const& rhs) {
+    checkOperandRows(lhs.mSize, rhs);
+    const int cols = rhs.size().second;
+    SmallMatrix newSmallMatrix = SmallMatrix(lhs.mSize, cols, 0.0);
+    for (int i {}; i < lhs.mSize; i++) {
+        double* newRow = detail::rowData(newSmallMatrix, i);
+        const int firstK = lhs.mTriangle == Triangle::Lower ? 0 : i;
+        const int lastK = lhs.mTriangle == Triangle::Lower ? i + 1 : lhs.mSize;
+        double const* packedRow = lhs.mPackedData.data() + lhs.packedIndex(i, firstK);
+        for (int k {firstK}; k < lastK; k++) {
+            const double scalar = packedRow[k - firstK];
+            double const* rhsRow = detail::rowData(rhs, k);
+            for (int j {}; j < cols; j++) {
+                newRow[j] += scalar * rhsRow[j];
+            }
+        }
+    }
+    return newSmallMatrix;
+}
+
+std::vector<double> operator*(TriangularMatrix const& lhs, std::vector<double> const& x) {
+    if (static_cast<int>(x.size()) != lhs.mSize) {
+        throw std::invalid_argument("Unequal dimensions!");
+    }
+    std::vector<double> y(lhs.mSize, 0.0);
+    for (int i {}; i < lhs.mSize; i++) {
+        const int firstK = lhs.mTriangle == Triangle::Lower ? 0 : i;
+        const int lastK = lhs.mTriangle == Triangle::Lower ? i + 1 : lhs.mSize;
+        double const* packedRow = lhs.mPackedData.data() + lhs.packedIndex(i, firstK);
+        for (int k {firstK}; k < lastK; k++) {
+            y[i] += packedRow[k - firstK] * x[k];
+        }
+    }
+    return y;
+}
+
+SmallMatrix solve(TriangularMatrix const& lhs, SmallMatrix const& rhs) {
+    checkOperandRows(lhs.mSize, rhs);
+    const int cols = rhs.size().second;
+    SmallMatrix solution = rhs;
+
+    // Forward substitution for a lower triangle and back substitution for an upper triangle. Each
+    // row of the solution only depends on rows that have already been solved.
+    const bool isLower = lhs.mTriangle == Triangle::Lower;
+    for (int step {}; step < lhs.mSize; step++) {
+        const int i = isLower ? step : lhs.mSize - 1 - step;
+        const double divisor = lhs.mPackedData[lhs.packedIndex(i, i)];
+        if (divisor == 0.0) {
+            throw std::invalid_argument("Singular matrix!");
+        }
+
+        double* row = detail::rowData(solution, i);
+        const int firstK = isLower ? 0 : i + 1;
+        const int lastK = isLower ? i : lhs.mSize;
+        for (int k {firstK}; k < lastK; k++) {
+            const double scalar = lhs.mPackedData[lhs.packedIndex(i, k)];
+            double const* solvedRow = detail::rowData(solution, k);
+            for (int j {}; j < cols; j++) {
+                row[j] -= scalar * solvedRow[j];
+            }
+        }
+        for (int j {}; j < cols; j++) {
+            row[j] /= divisor;
+        }
+    }
+    return solution;
+}
+
+TriangularMatrix transpose(TriangularMatrix const& tm) {
+    TriangularMatrix newTriangularMatrix = TriangularMatrix(
+        tm.mSize, tm.mTriangle == Triangle::Lower ? Triangle::Upper : Triangle::Lower);
+    for (int i {}; i < tm.mSize; i++) {
+        for (int j {}; j < tm.mSize; j++) {
+            if (tm.isStored(i, j)) {
+                newTriangularMatrix.mPackedData[newTriangularMatrix.packedIndex(j, i)] = tm.mPackedData[tm.packedIndex(i, j)];
+            }
+        }
+    }
+    return newTriangularMatrix;
+}
+
+SymmetricMatrix::SymmetricMatrix(int size)
+    :   mSize {size} {
+    if (size < 0) {
+        throw std::out_of_range("Out of Range! Illegal size");
+    }
+    mPackedData.assign(static_cast<std::size_t>(size) * (size + 1) / 2, 0.0);
+}
+
+SymmetricMatrix::SymmetricMatrix(SmallMatrix const& sm)
+    :   SymmetricMatrix(sm.size().first) {
+    if (sm.size().first != sm.size().second) {
+        throw std::invalid_argument("Matrix is not square!");
+    }
+    for (int i {}; i < mSize; i++) {
+        double const* row = detail::rowData(sm, i);
+        std::copy(row, row + i + 1, mPackedData.begin() + i * (i + 1) / 2);
+    }
+}
+
+SmallMatrix SymmetricMatrix::toSmallMatrix() const {
+    SmallMatrix sm = SmallMatrix(mSize, mSize);
+    for (int i {}; i < mSize; i++) {
+        for (int j {}; j <= i; j++) {
+            detail::rowData(sm, i)[j] = mPackedData[i * (i + 1) / 2 + j];
+            detail::rowData(sm, j)[i] = mPackedData[i * (i + 1) / 2 + j];
+        }
+    }
+    return sm;
+}
+
+const double& SymmetricMatrix::operator()(int numRow, int numCol) const {
+    if (numRow >= mSize || numCol >= mSize || numRow < 0 || numCol < 0) {
+        throw std::out_of_range("Out Of Range!");
+    }
+    // Both (i, j) and (j, i) are stored once, in the lower triangle
+    const int row = std::max(numRow, numCol);
+    const int col = std::min(numRow, numCol);
+    return mPackedData.at(row * (row + 1) / 2 + col);
+}
+
+double& SymmetricMatrix::operator()(int numRow, int numCol) {
+    return const_cast<double&>(const_cast<const SymmetricMatrix*>(this)->operator()(numRow, numCol));
+}
+
+std::pair<int, int> SymmetricMatrix::size() const { return {std::make_pair(mSize, mSize)}; }
+
+SmallMatrix operator*(SymmetricMatrix const& lhs, SmallMatrix const& rhs) {
+    checkOperandRows(lhs.mSize, rhs);
+    const int cols = rhs.size().second;
+    SmallMatrix newSmallMatrix = SmallMatrix(lhs.mSize, cols, 0.0);
+
+    // Each stored element (i, k) of the lower triangle contributes to row i and, off the diagonal,
+    // to row k as element (k, i)
+    for (int i {}; i < lhs.mSize; i++) {
+        double const* packedRow = lhs.mPackedData.data() + i * (i + 1) / 2;
+        double* newRow = detail::rowData(newSmallMatrix, i);
+        double const* rhsRow = detail::rowData(rhs, i);
+        for (int k {}; k <= i; k++) {
+            const double scalar = packedRow[k];
+            double const* rhsRowK = detail::rowData(rhs, k);
+            for (int j {}; j < cols; j++) {
+                newRow[j] += scalar * rhsRowK[j];
+            }
+            if (k < i) {
+                double* newRowK = detail::rowData(newSmallMatrix, k);
+                for (int j {}; j < cols; j++) {
+                    newRowK[j] += scalar * rhsRow[j];
+                }
+            }
+        }
+    }
+    return newSmallMatrix;
+}
+
+std::vector<double> operator*(SymmetricMatrix const& lhs, std::vector<double> const& x) {
+    if (static_cast<int>(x.size()) != lhs.mSize) {
+        throw std::invalid_argument("Unequal dimensions!");
+    }
+    std::vector<double> y(lhs.mSize, 0.0);
+    for (int i {}; i < lhs.mSize; i++) {
+        double const* packedRow = lhs.mPackedData.data() + i * (i + 1) / 2;
+        for (int k {}; k < i; k++) {
+            y[i] += packedRow[k] * x[k];
+            y[k] += packedRow[k] * x[i];
+        }
+        y[i] += packedRow[i] * x[i];
+    }
+    return y;
+}
+
+SmallMatrix solve(SymmetricMatrix const& lhs, SmallMatrix const& rhs) {
+    checkOperandRows(lhs.mSize, rhs);
+
+    // Cholesky factorisation lhs = L * L^T, where L has the same packed layout as the lower
+    // triangle. Each element only needs dot products of already factorised rows.
+    std::vector<double> factor(lhs.mPackedData.size());
+    for (int i {}; i < lhs.mSize; i++) {
+        double const* rowI = factor.data() + i * (i + 1) / 2;
+        for (int j {}; j <= i; j++) {
+            double const* rowJ = factor.data() + j * (j + 1) / 2;
+            double value = lhs.mPackedData[i * (i + 1) / 2 + j];
+            for (int k {}; k < j; k++) {
+                value -= rowI[k] * rowJ[k];
+            }
+            if (i == j) {
+                // Not positive definite, so fall back to pivoted elimination of the dense matrix
+                if (!(value > 0.0)) {
+                    return solve(lhs.toSmallMatrix(), rhs);
+                }
+                factor[i * (i + 1) / 2 + j] = std::sqrt(value);
+            } else {
+                factor[i * (i + 1) / 2 + j] = value / rowJ[j];
+            }
+        }
+    }
+
+    TriangularMatrix lower = TriangularMatrix(lhs.mSize, Triangle::Lower);
+    for (int i {}; i < lhs.mSize; i++) {
+        for (int j {}; j <= i; j++) {
+            lower(i, j) = factor[i * (i + 1) / 2 + j];
+        }
+    }
+    return solve(transpose(lower), solve(lower, rhs));
+}
+
+SymmetricMatrix transpose(SymmetricMatrix const& sm) {
+    return sm;
+}
+
+BandedMatrix::BandedMatrix(int size, int numLower, int numUpper)
+    :   mSize {size},
+        mNumLower {numLower},
+        mNumUpper {numUpper} {
+    if (size < 0 || numLower < 0 || numUpper < 0) {
+        throw std::out_of_range("Out of Range! Illegal size or bandwidth");
+    }
+    mBandData.assign(static_cast<std::size_t>(size) * (numLower + numUpper + 1), 0.0);
+}
+
+BandedMatrix::BandedMatrix(SmallMatrix const& sm, int numLower, int numUpper)
+    :   BandedMatrix(sm.size().first, numLower, numUpper) {
+    if (sm.size().first != sm.size().second) {
+        throw std::invalid_argument("Matrix is not square!");
+    }
+    const int width = mNumLower + mNumUpper + 1;
+    for (int i {}; i < mSize; i++) {
+        double const* row = detail::rowData(sm, i);
+        const int firstCol = std::max(0, i - mNumLower);
+        const int lastCol = std::min(mSize, i + mNumUpper + 1);
+        std::copy(row + firstCol, row + lastCol, mBandData.begin() + i * width + (firstCol - i + mNumLower));
+    }
+}
+
+SmallMatrix BandedMatrix::toSmallMatrix() const {
+    SmallMatrix sm = SmallMatrix(mSize, mSize, 0.0);
+    const int width = mNumLower + mNumUpper + 1;
+    for (int i {}; i < mSize; i++) {
+        const int firstCol = std::max(0, i - mNumLower);
+        const int lastCol = std::min(mSize, i + mNumUpper + 1);
+        auto const first = mBandData.cbegin() + i * width + (firstCol - i + mNumLower);
+        std::copy(first, first + (lastCol - firstCol), detail::rowData(sm, i) + firstCol);
+    }
+    return sm;
+}
+
+double BandedMatrix::operator()(int numRow, int numCol) const {
+    if (numRow >= mSize || numCol >= mSize || numRow < 0 || numCol < 0) {
+        throw std::out_of_range("Out Of Range!");
+    }
+    if (!isStored(numRow, numCol)) {
+        return 0.0;
+    }
+    return mBandData.at(numRow * (mNumLower + mNumUpper + 1) + (numCol - numRow + mNumLower));
+}
+
+double& BandedMatrix::operator()(int numRow, int numCol) {
+    if (numRow >= mSize || numCol >= mSize || numRow < 0 || numCol < 0 || !isStored(numRow, numCol)) {
+        throw std::out_of_range("Out Of Range!");
+    }
+    return mBandData.at(numRow * (mNumLower + mNumUpper + 1) + (numCol - numRow + mNumLower));
+}
+
+std::pair<int, int> BandedMatrix::size() const { return {std::make_pair(mSize, mSize)}; }
+
+std::pair<int, int> BandedMatrix::bandwidth() const { return {std::make_pair(mNumLower, mNumUpper)}; }
+
+bool BandedMatrix::isStored(int numRow, int numCol) const {
+    return numCol - numRow >= -mNumLower && numCol - numRow <= mNumUpper;
+}
+
+SmallMatrix operator*(BandedMatrix const& lhs, SmallMatrix const& rhs) {
+    checkOperandRows(lhs.mSize, rhs);
+    const int cols = rhs.size().second;
+    const int width = lhs.mNumLower + lhs.mNumUpper + 1;
+    SmallMatrix newSmallMatrix = SmallMatrix(lhs.mSize, cols, 0.0);
+    for (int i {}; i < lhs.mSize; i++) {
+        double* newRow = detail::rowData(newSmallMatrix, i);
+        double const* bandRow = lhs.mBandData.data() + i * width - i + lhs.mNumLower;
+        for (int k {std::max(0, i - lhs.mNumLower)}; k < std::min(lhs.mSize, i + lhs.mNumUpper + 1); k++) {
+            const double scalar = bandRow[k];
+            double const* rhsRow = detail::rowData(rhs, k);
+            for (int j {}; j < cols; j++) {
+                newRow[j] += scalar * rhsRow[j];
+            }
+        }
+    }
+    return newSmallMatrix;
+}
+
+std::vector<double> operator*(BandedMatrix const& lhs, std::vector<double> const& x) {
+    if (static_cast<int>(x.size()) != lhs.mSize) {
+        throw std::invalid_argument("Unequal dimensions!");
+    }
+    const int width = lhs.mNumLower + lhs.mNumUpper + 1;
+    std::vector<double> y(lhs.mSize, 0.0);
+    for (int i {}; i < lhs.mSize; i++) {
+        double const* bandRow = lhs.mBandData.data() + i * width - i + lhs.mNumLower;
+        for (int k {std::max(0, i - lhs.mNumLower)}; k < std::min(lhs.mSize, i + lhs.mNumUpper + 1); k++) {
+            y[i] += bandRow[k] * x[k];
+        }
+    }
+    return y;
+}
+
+SmallMatrix solve(BandedMatrix const& lhs, SmallMatrix const& rhs) {
+    checkOperandRows(lhs.mSize, rhs);
+    const int size = lhs.mSize;
+    const int cols = rhs.size().second;
+    const int numLower = lhs.mNumLower;
+    const int numUpper = lhs.mNumUpper;
+
+    // Row swaps can push elements up to numLower + numUpper above the diagonal, so the working
+    // band is widened by numLower. Element (i, j) lives at work[i * width + j - i + numLower].
+    const int width = 2 * numLower + numUpper + 1;
+    std::vector<double> work(static_cast<std::size_t>(size) * width, 0.0);
+    for (int i {}; i < size; i++) {
+        for (int j {std::max(0, i - numLower)}; j < std::min(size, i + numUpper + 1); j++) {
+            work[i * width + j - i + numLower] = lhs.mBandData[i * (numLower + numUpper + 1) + j - i + numLower];
+        }
+    }
+    auto element = [&](int i, int j) -> double& { return work[i * width + j - i + numLower]; };
+
+    SmallMatrix solution = rhs;
+    for (int k {}; k < size; k++) {
+        const int lastRow = std::min(size - 1, k + numLower);
+        const int lastCol = std::min(size - 1, k + numLower + numUpper);
+
+        int pivotRow {k};
+        for (int i {k + 1}; i <= lastRow; i++) {
+            if (std::abs(element(i, k)) > std::abs(element(pivotRow, k))) {
+                pivotRow = i;
+            }
+        }
+        if (element(pivotRow, k) == 0.0) {
+            throw std::invalid_argument("Singular matrix!");
+        }
+        if (pivotRow != k) {
+            for (int j {k}; j <= lastCol; j++) {
+                std::swap(element(k, j), element(pivotRow, j));
+            }
+            std::swap_ranges(detail::rowData(solution, k), detail::rowData(solution, k) + cols, detail::rowData(solution, pivotRow));
+        }
+
+        double const* pivotSolution = detail::rowData(solution, k);
+        for (int i {k + 1}; i <= lastRow; i++) {
+            const double multiplier = element(i, k) / element(k, k);
+            if (multiplier == 0.0) {
+                continue;
+            }
+            for (int j {k + 1}; j <= lastCol; j++) {
+                element(i, j) -= multiplier * element(k, j);
+            }
+            double* rowSolution = detail::rowData(solution, i);
+            for (int j {}; j < cols; j++) {
+                rowSolution[j] -= multiplier * pivotSolution[j];
+            }
+        }
+    }
+
+    for (int i {size - 1}; i >= 0; i--) {
+        double* rowSolution = detail::rowData(solution, i);
+        for (int k {i + 1}; k <= std::min(size - 1, i + numLower + numUpper); k++) {
+            const double scalar = element(i, k);
+            double const* solvedRow = detail::rowData(solution, k);
+            for (int j {}; j < cols; j++) {
+                rowSolution[j] -= scalar * solvedRow[j];
+            }
+        }
+        for (int j {}; j < cols; j++) {
+            rowSolution[j] /= element(i, i);
+        }
+    }
+    return solution;
+}
+
+BandedMatrix transpose(BandedMatrix const& bm) {
+    BandedMatrix newBandedMatrix = BandedMatrix(bm.mSize, bm.mNumUpper, bm.mNumLower);
+    for (int i {}; i < bm.mSize; i++) {
+        for (int j {std::max(0, i - bm.mNumLower)}; j < std::min(bm.mSize, i + bm.mNumUpper + 1); j++) {
+            newBandedMatrix(j, i) = bm(i, j);
+        }
+    }
+    return newBandedMatrix;
+}
+
+}  // namespace smallMatrix
@@ -0,0 +1,529 @@
+/**
+ * @file StructuredMatrix.hpp
+ * @author Mohamad Baydoun
+ * @brief Header file for StructuredMatrix.cpp
+ */
+#pragma once
+
+#include "SmallMatrix.hpp"
+
+#include <utility>
+#include <vector>
+
+namespace smallMatrix {
+
+class DiagonalMatrix {
+public:
+    /**
+     * @brief A constructor which initialises a square zero matrix of the given size. Only the n
+     *        diagonal elements are stored.
+     *
+     * @param size Number of rows and columns.
+     * @throw Throws out_of_range if size is negative.
+     */
+    explicit DiagonalMatrix(int size);
+
+    /**
+     * @brief A constructor which initialises a square matrix with the given diagonal elements.
+     *
+     * @param diagonal Elements of the main diagonal.
+     */
+    explicit DiagonalMatrix(std::vector<double> diagonal);
+
+    /**
+     * @brief A constructor which initialises a diagonal matrix with the main diagonal of the
+     *        specified matrix. Elements off the diagonal are ignored.
+     *
+     * @param sm Square SmallMatrix.
+     * @throw Throws invalid_argument if the matrix is not square.
+     */
+    explicit DiagonalMatrix(SmallMatrix const& sm);
+
+    /**
+     * @brief Returns a dense SmallMatrix holding the same elements.
+     *
+     * @return SmallMatrix
+     */
+    SmallMatrix toSmallMatrix() const;
+
+    /**
+     * @brief Returns the element at the specified row and column index, which is zero off the
+     *        diagonal.
+     *
+     * @param numRow Row index.
+     * @param numCol Column index.
+     * @return double
+     * @throw Throws out_of_range if the specified row and column is outside the matrix.
+     */
+    double operator()(int numRow, int numCol) const;
+
+    /**
+     * @brief Returns the reference of the diagonal element at the specified index.
+     *
+     * @param index Row and column index.
+     * @return double&
+     * @throw Throws out_of_range if the index is outside the range [0, size).
+     */
+    double& diagonal(int index);
+
+    /**
+     * @brief Returns the size of the matrix where the first of the pair is the number of rows and
+     *        the second of the pair is the number of columns.
+     *
+     * @return std::pair<int, int>
+     */
+    std::pair<int, int> size() const;
+
+    /**
+     * @brief Returns the product of the diagonal matrix and the specified matrix, which scales
+     *        each row of the matrix.
+     *
+     * @param lhs Diagonal matrix.
+     * @param rhs SmallMatrix.
+     * @return SmallMatrix
+     * @throw Throws invalid_argument if the dimensions do not match.
+     */
+    friend SmallMatrix operator*(DiagonalMatrix const& lhs, SmallMatrix const& rhs);
+
+    /**
+     * @brief Returns the product of the specified matrix and the diagonal matrix, which scales
+     *        each column of the matrix.
+     *
+     * @param lhs SmallMatrix.
+     * @param rhs Diagonal matrix.
+     * @return SmallMatrix
+     * @throw Throws invalid_argument if the dimensions do not match.
+     */
+    friend SmallMatrix operator*(SmallMatrix const& lhs, DiagonalMatrix const& rhs);
+
+    /**
+     * @brief Returns the product of two diagonal matrices in O(n).
+     *
+     * @param lhs Left-hand side diagonal matrix.
+     * @param rhs Right-hand side diagonal matrix.
+     * @return DiagonalMatrix
+     * @throw Throws invalid_argument if the dimensions do not match.
+     */
+    friend DiagonalMatrix operator*(DiagonalMatrix const& lhs, DiagonalMatrix const& rhs);
+
+    /**
+     * @brief Returns the product of the diagonal matrix and the column vector in O(n).
+     *
+     * @param lhs Diagonal matrix.
+     * @param x Column vector.
+     * @return std::vector<double>
+     * @throw Throws invalid_argument if the dimensions do not match.
+     */
+    friend std::vector<double> operator*(DiagonalMatrix const& lhs, std::vector<double> const& x);
+
+    /**
+     * @brief Returns the solution X of lhs * X = rhs by dividing each row of rhs by the
+     *        corresponding diagonal element.
+     *
+     * @param lhs Diagonal matrix.
+     * @param rhs Right-hand side matrix.
+     * @return SmallMatrix
+     * @throw Throws invalid_argument if the dimensions do not match.
+     * @throw Throws invalid_argument if any diagonal element is zero.
+     */
+    friend SmallMatrix solve(DiagonalMatrix const& lhs, SmallMatrix const& rhs);
+
+    /**
+     * @brief Returns the transpose of the diagonal matrix, which is the matrix itself.
+     *
+     * @param dm Diagonal matrix.
+     * @return DiagonalMatrix
+     */
+    friend DiagonalMatrix transpose(DiagonalMatrix const& dm);
+
+private:
+    std::vector<double> mDiagonal;
+};
+
+/**
+ * @brief Which triangle of a TriangularMatrix holds its elements.
+ */
+enum class Triangle {
+    Lower,
+    Upper
+};
+
+class TriangularMatrix {
+public:
+    /**
+     * @brief A constructor which initialises a square zero matrix of the given size. Only the
+     *        n(n+1)/2 elements of the given triangle, including the diagonal, are stored.
+     *
+     * @param size Number of rows and columns.
+     * @param triangle Triangle which holds the elements.
+     * @throw Throws out_of_range if size is negative.
+     */
+    TriangularMatrix(int size, Triangle triangle);
+
+    /**
+     * @brief A constructor which initialises a triangular matrix with the given triangle of the
+     *        specified matrix. Elements outside the triangle are ignored.
+     *
+     * @param sm Square SmallMatrix.
+     * @param triangle Triangle to copy.
+     * @throw Throws invalid_argument if the matrix is not square.
+     */
+    TriangularMatrix(SmallMatrix const& sm, Triangle triangle);
+
+    /**
+     * @brief Returns a dense SmallMatrix holding the same elements.
+     *
+     * @return SmallMatrix
+     */
+    SmallMatrix toSmallMatrix() const;
+
+    /**
+     * @brief Returns the element at the specified row and column index, which is zero outside the
+     *        triangle.
+     *
+     * @param numRow Row index.
+     * @param numCol Column index.
+     * @return double
+     * @throw Throws out_of_range if the specified row and column is outside the matrix.
+     */
+    double operator()(int numRow, int numCol) const;
+
+    /**
+     * @brief Returns the reference of the stored element at the specified row and column index.
+     *
+     * @param numRow Row index.
+     * @param numCol Column index.
+     * @return double&
+     * @throw Throws out_of_range if the specified row and column is outside the matrix or outside
+     *        the triangle.
+     */
+    double& operator()(int numRow, int numCol);
+
+    /**
+     * @brief Returns the size of the matrix where the first of the pair is the number of rows and
+     *        the second of the pair is the number of columns.
+     *
+     * @return std::pair<int, int>
+     */
+    std::pair<int, int> size() const;
+
+    /**
+     * @brief Returns the triangle which holds the elements.
+     *
+     * @return Triangle
+     */
+    Triangle triangle() const;
+
+    /**
+     * @brief Returns the product of the triangular matrix and the specified matrix, skipping the
+     *        zero triangle.
+     *
+     * @param lhs Triangular matrix.
+     * @param rhs SmallMatrix.
+     * @return SmallMatrix
+     * @throw Throws invalid_argument if the dimensions do not match.
+     */
+    friend SmallMatrix operator*(TriangularMatrix const& lhs, SmallMatrix const& rhs);
+
+    /**
+     * @brief Returns the product of the triangular matrix and the column vector.
+     *
+     * @param lhs Triangular matrix.
+     * @param x Column vector.
+     * @return std::vector<double>
+     * @throw Throws invalid_argument if the dimensions do not match.
+     */
+    friend std::vector<double> operator*(TriangularMatrix const& lhs, std::vector<double> const& x);
+
+    /**
+     * @brief Returns the solution X of lhs * X = rhs by forward substitution for a lower
+     *        triangular matrix or back substitution for an upper triangular matrix, in O(n^2) per
+     *        column of rhs.
+     *
+     * @param lhs Triangular matrix.
+     * @param rhs Right-hand side matrix.
+     * @return SmallMatrix
+     * @throw Throws invalid_argument if the dimensions do not match.
+     * @throw Throws invalid_argument if any diagonal element is zero.
+     */
+    friend SmallMatrix solve(TriangularMatrix const& lhs, SmallMatrix const& rhs);
+
+    /**
+     * @brief Returns the transpose of the triangular matrix, which is stored in the opposite
+     *        triangle.
+     *
+     * @param tm Triangular matrix.
+     * @return TriangularMatrix
+     */
+    friend TriangularMatrix transpose(TriangularMatrix const& tm);
+
+private:
+    /**
+     * @brief Returns the position of the element in packed storage. The element must lie within
+     *        the triangle.
+     *
+     * @param numRow Row index.
+     * @param numCol Column index.
+     * @return int
+     */
+    int packedIndex(int numRow, int numCol) const;
+
+    /**
+     * @brief Returns true if the element lies within the stored triangle.
+     *
+     * @param numRow Row index.
+     * @param numCol Column index.
+     * @return true, if the element is stored.
+     * @return false, otherwise.
+     */
+    bool isStored(int numRow, int numCol) const;
+
+    int mSize;
+    Triangle mTriangle;
+    std::vector<double> mPackedData;
+};
+
+class SymmetricMatrix {
+public:
+    /**
+     * @brief A constructor which initialises a square zero matrix of the given size. Only the
+     *        n(n+1)/2 elements of the lower triangle are stored.
+     *
+     * @param size Number of rows and columns.
+     * @throw Throws out_of_range if size is negative.
+     */
+    explicit SymmetricMatrix(int size);
+
+    /**
+     * @brief A constructor which initialises a symmetric matrix with the lower triangle of the
+     *        specified matrix. The upper triangle is ignored.
+     *
+     * @param sm Square SmallMatrix.
+     * @throw Throws invalid_argument if the matrix is not square.
+     */
+    explicit SymmetricMatrix(SmallMatrix const& sm);
+
+    /**
+     * @brief Returns a dense SmallMatrix holding the same elements.
+     *
+     * @return SmallMatrix
+     */
+    SmallMatrix toSmallMatrix() const;
+
+    /**
+     * @brief Returns the constant reference of the element at the specified row and column index.
+     *        Elements (i, j) and (j, i) share the same storage.
+     *
+     * @param numRow Row index.
+     * @param numCol Column index.
+     * @return const double&
+     * @throw Throws out_of_range if the specified row and column is outside the matrix.
+     */
+    const double& operator()(int numRow, int numCol) const;
+
+    /**
+     * @brief Returns the reference of the element at the specified row and column index, so
+     *        assigning to (i, j) also assigns to (j, i).
+     *
+     * @param numRow Row index.
+     * @param numCol Column index.
+     * @return double&
+     * @throw Throws out_of_range if the specified row and column is outside the matrix.
+     */
+    double& operator()(int numRow, int numCol);
+
+    /**
+     * @brief Returns the size of the matrix where the first of the pair is the number of rows and
+     *        the second of the pair is the number of columns.
+     *
+     * @return std::pair<int, int>
+     */
+    std::pair<int, int> size() const;
+
+    /**
+     * @brief Returns the product of the symmetric matrix and the specified matrix, reading only
+     *        the stored triangle.
+     *
+     * @param lhs Symmetric matrix.
+     * @param rhs SmallMatrix.
+     * @return SmallMatrix
+     * @throw Throws invalid_argument if the dimensions do not match.
+     */
+    friend SmallMatrix operator*(SymmetricMatrix const& lhs, SmallMatrix const& rhs);
+
+    /**
+     * @brief Returns the product of the symmetric matrix and the column vector.
+     *
+     * @param lhs Symmetric matrix.
+     * @param x Column vector.
+     * @return std::vector<double>
+     * @throw Throws invalid_argument if the dimensions do not match.
+     */
+    friend std::vector<double> operator*(SymmetricMatrix const& lhs, std::vector<double> const& x);
+
+    /**
+     * @brief Returns the solution X of lhs * X = rhs. A Cholesky factorisation is used when the
+     *        matrix is positive definite, and Gaussian elimination with partial pivoting
+     *        otherwise.
+     *
+     * @param lhs Symmetric matrix.
+     * @param rhs Right-hand side matrix.
+     * @return SmallMatrix
+     * @throw Throws invalid_argument if the dimensions do not match.
+     * @throw Throws invalid_argument if the matrix is singular.
+     */
+    friend SmallMatrix solve(SymmetricMatrix const& lhs, SmallMatrix const& rhs);
+
+    /**
+     * @brief Returns the transpose of the symmetric matrix, which is the matrix itself.
+     *
+     * @param sm Symmetric matrix.
+     * @return SymmetricMatrix
+     */
+    friend SymmetricMatrix transpose(SymmetricMatrix const& sm);
+
+private:
+    int mSize;
+    std::vector<double> mPackedData;
+};
+
+class BandedMatrix {
+public:
+    /**
+     * @brief A constructor which initialises a square zero matrix of the given size whose non-zero
+     *        elements lie at most numLower below and numUpper above the main diagonal. Only the
+     *        n(numLower + numUpper + 1) elements of the band are stored.
+     *
+     * @param size Number of rows and columns.
+     * @param numLower Number of sub-diagonals.
+     * @param numUpper Number of super-diagonals.
+     * @throw Throws out_of_range if any argument is negative.
+     */
+    BandedMatrix(int size, int numLower, int numUpper);
+
+    /**
+     * @brief A constructor which initialises a banded matrix with the band of the specified
+     *        matrix. Elements outside the band are ignored.
+     *
+     * @param sm Square SmallMatrix.
+     * @param numLower Number of sub-diagonals.
+     * @param numUpper Number of super-diagonals.
+     * @throw Throws invalid_argument if the matrix is not square.
+     * @throw Throws out_of_range if numLower or numUpper is negative.
+     */
+    BandedMatrix(SmallMatrix const& sm, int numLower, int numUpper);
+
+    /**
+     * @brief Returns a dense SmallMatrix holding the same elements.
+     *
+     * @return SmallMatrix
+     */
+    SmallMatrix toSmallMatrix() const;
+
+    /**
+     * @brief Returns the element at the specified row and column index, which is zero outside the
+     *        band.
+     *
+     * @param numRow Row index.
+     * @param numCol Column index.
+     * @return double
+     * @throw Throws out_of_range if the specified row and column is outside the matrix.
+     */
+    double operator()(int numRow, int numCol) const;
+
+    /**
+     * @brief Returns the reference of the stored element at the specified row and column index.
+     *
+     * @param numRow Row index.
+     * @param numCol Column index.
+     * @return double&
+     * @throw Throws out_of_range if the specified row and column is outside the matrix or outside
+     *        the band.
+     */
+    double& operator()(int numRow, int numCol);
+
+    /**
+     * @brief Returns the size of the matrix where the first of the pair is the number of rows and
+     *        the second of the pair is the number of columns.
+     *
+     * @return std::pair<int, int>
+     */
+    std::pair<int, int> size() const;
+
+    /**
+     * @brief Returns the number of sub-diagonals and super-diagonals of the band.
+     *
+     * @return std::pair<int, int>
+     */
+    std::pair<int, int> bandwidth() const;
+
+    /**
+     * @brief Returns the product of the banded matrix and the specified matrix, skipping the
+     *        elements outside the band.
+     *
+     * @param lhs Banded matrix.
+     * @param rhs SmallMatrix.
+     * @return SmallMatrix
+     * @throw Throws invalid_argument if the dimensions do not match.
+     */
+    friend SmallMatrix operator*(BandedMatrix const& lhs, SmallMatrix const& rhs);
+
+    /**
+     * @brief Returns the product of the banded matrix and the column vector.
+     *
+     * @param lhs Banded matrix.
+     * @param x Column vector.
+     * @return std::vector<double>
+     * @throw Throws invalid_argument if the dimensions do not match.
+     */
+    friend std::vector<double> operator*(BandedMatrix const& lhs, std::vector<double> const& x);
+
+    /**
+     * @brief Returns the solution X of lhs * X = rhs, computed by banded Gaussian elimination with
+     *        partial pivoting in O(n * numLower * (numLower + numUpper)) per column of rhs.
+     *
+     * @param lhs Banded matrix.
+     * @param rhs Right-hand side matrix.
+     * @return SmallMatrix
+     * @throw Throws invalid_argument if the dimensions do not match.
+     * @throw Throws invalid_argument if the matrix is singular.
+     */
+    friend SmallMatrix solve(BandedMatrix const& lhs, SmallMatrix const& rhs);
+
+    /**
+     * @brief Returns the transpose of the banded matrix, whose sub-diagonals and super-diagonals
+     *        are swapped.
+     *
+     * @param bm Banded matrix.
+     * @return BandedMatrix
+     */
+    friend BandedMatrix transpose(BandedMatrix const& bm);
+
+private:
+    /**
+     * @brief Returns true if the element lies within the band.
+     *
+     * @param numRow Row index.
+     * @param numCol Column index.
+     * @return true, if the element is stored.
+     * @return false, otherwise.
+     */
+    bool isStored(int numRow, int numCol) const;
+
+    int mSize;
+    int mNumLower;
+    int mNumUpper;
+    std::vector<double> mBandData;
+};
+
+// Forward declaring.
+DiagonalMatrix transpose(DiagonalMatrix const&);
+TriangularMatrix transpose(TriangularMatrix const&);
+SymmetricMatrix transpose(SymmetricMatrix const&);
+BandedMatrix transpose(BandedMatrix const&);
+SmallMatrix solve(DiagonalMatrix const&, SmallMatrix const&);
+SmallMatrix solve(TriangularMatrix const&, SmallMatrix const&);
+SmallMatrix solve(SymmetricMatrix const&, SmallMatrix const&);
+SmallMatrix solve(BandedMatrix const&, SmallMatrix const&);
+
+}  // namespace smallMatrix
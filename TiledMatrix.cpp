@@ -0,0 +1,169 @@
+/*
+Tiled storage for large matrices in the Small Matrix program.
+*/
+
+#include "TiledMatrix.hpp"
+#include "Tuner.hpp"
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+namespace smallMatrix {
+
+namespace {
+
+// Interleaves the bits of the tile row and column index, giving the position of the tile along a
+// Z-order curve
+unsigned long long mortonCode(unsigned tileRow, unsigned tileCol) {
+    unsigned long long code {};
+    for (int bit {}; bit < 32; bit++) {
+        code |= static_cast<unsigned long long>((tileCol >> bit) & 1u) << (2 * bit);
+        code |= static_cast<unsigned long long>((tileRow >> bit) & 1u) << (2 * bit + 1);
+    }
+    return code;
+}
+
+}  // namespace
+
+TiledMatrix::TiledMatrix()
+    :   TiledMatrix(0, 0) {}
+
+TiledMatrix::TiledMatrix(int numRows, int numCols, TileOrder order)
+    :   mNumRows {numRows},
+        mNumCols {numCols},
+        mNumTileRows {},
+        mNumTileCols {},
+        mOrder {order} {
+    if (numRows < 0 || numCols < 0) {
+        throw std::out_of_range("Out of Range! Illegal row or column size");
+    }
+    mNumTileRows = (numRows + tileSize - 1) / tileSize;
+    mNumTileCols = (numCols + tileSize - 1) / tileSize;
+
+    // mTileSlots maps the row-major index of a tile to its position in storage
+    const int numTiles = mNumTileRows * mNumTileCols;
+    std::vector<int> tiles(numTiles);
+    std::iota(tiles.begin(), tiles.end(), 0);
+    if (mOrder == TileOrder::Morton) {
+        std::sort(tiles.begin(), tiles.end(), [&](int lhs, int rhs) {
+            return mortonCode(lhs / mNumTileCols, lhs % mNumTileCols) < mortonCode(rhs / mNumTileCols, rhs % mNumTileCols);
+        });
+    }
+    mTileSlots.resize(numTiles);
+    for (int slot {}; slot < numTiles; slot++) {
+        mTileSlots.at(tiles.at(slot)) = slot;
+    }
+    mData.assign(static_cast<std::size_t>(numTiles) * tileSize * tileSize, 0.0);
+}
+
+TiledMatrix::TiledMatrix(SmallMatrix const& sm, TileOrder order)
+    :   TiledMatrix(sm.mNumRows, sm.mNumCols, order) {
+    for (int i {}; i < mNumRows; i++) {
+        double const* row = sm.rowData(i);
+        for (int tileCol {}; tileCol < mNumTileCols; tileCol++) {
+            const int firstCol = tileCol * tileSize;
+            const int lastCol = std::min(firstCol + tileSize, mNumCols);
+            std::copy(row + firstCol, row + lastCol, tileData(i / tileSize, tileCol) + (i % tileSize) * tileSize);
+        }
+    }
+}
+
+SmallMatrix TiledMatrix::toSmallMatrix() const {
+    SmallMatrix sm = SmallMatrix(mNumRows, mNumCols);
+    for (int i {}; i < mNumRows; i++) {
+        double* row = sm.rowData(i);
+        for (int tileCol {}; tileCol < mNumTileCols; tileCol++) {
+            const int firstCol = tileCol * tileSize;
+            const int lastCol = std::min(firstCol + tileSize, mNumCols);
+            double const* tileRow = tileData(i / tileSize, tileCol) + (i % tileSize) * tileSize;
+            std::copy(tileRow, tileRow + (lastCol - firstCol), row + firstCol);
+        }
+    }
+    return sm;
+}
+
+double& TiledMatrix::operator()(int numRow, int numCol) {
+    return const_cast<double&>(const_cast<const TiledMatrix*>(this)->operator()(numRow, numCol));
+}
+
+const double& TiledMatrix::operator()(int numRow, int numCol) const {
+    if (numRow >= mNumRows || numCol >= mNumCols || numRow < 0 || numCol < 0) {
+        throw std::out_of_range("Out Of Range!");
+    }
+    return tileData(numRow / tileSize, numCol / tileSize)[(numRow % tileSize) * tileSize + numCol % tileSize];
+}
+
+std::pair<int, int> TiledMatrix::size() const { return {std::make_pair(mNumRows, mNumCols)}; }
+
+TileOrder TiledMatrix::order() const { return mOrder; }
+
+double* TiledMatrix::tileData(int tileRow, int tileCol) {
+    return const_cast<double*>(const_cast<const TiledMatrix*>(this)->tileData(tileRow, tileCol));
+}
+
+double const* TiledMatrix::tileData(int tileRow, int tileCol) const {
+    return mData.data() + static_cast<std::size_t>(mTileSlots[tileRow * mNumTileCols + tileCol]) * tileSize * tileSize;
+}
+
+TiledMatrix operator*(TiledMatrix const& lhs, TiledMatrix const& rhs) {
+    return multiply(lhs, rhs, ExecutionPolicy::Parallel);
+}
+
+TiledMatrix multiply(TiledMatrix const& lhs, TiledMatrix const& rhs, ExecutionPolicy policy) {
+    if (lhs.mNumCols != rhs.mNumRows) {
+        throw std::invalid_argument("Unequal dimensions!");
+    }
+
+    TiledMatrix newTiledMatrix = TiledMatrix(lhs.mNumRows, rhs.mNumCols, lhs.mOrder);
+    constexpr int size = TiledMatrix::tileSize;
+
+    // Each output tile is owned by one task, so tasks never write to the same memory. Padding is
+    // zero, so every tile product can run over the full tile.
+    const int numOutputTiles = newTiledMatrix.mNumTileRows * newTiledMatrix.mNumTileCols;
+    // The cutoff is counted in multiply-adds, as for the multiplication of a SmallMatrix
+    const long long work = static_cast<long long>(lhs.mNumRows) * lhs.mNumCols * rhs.mNumCols;
+    const bool parallel = policy == ExecutionPolicy::ThreadPool ||
+                          (policy == ExecutionPolicy::Parallel && work >= Tuner::parameters().multiplyParallelThreshold);
+    detail::parallelFor(numOutputTiles, [&](int tile) {
+        const int tileRow = tile / newTiledMatrix.mNumTileCols;
+        const int tileCol = tile % newTiledMatrix.mNumTileCols;
+        // Accumulating into a local tile lets the compiler vectorise without aliasing checks
+        double accumulator[size * size] {};
+        for (int tileInner {}; tileInner < lhs.mNumTileCols; tileInner++) {
+            double const* lhsTile = lhs.tileData(tileRow, tileInner);
+            double const* rhsTile = rhs.tileData(tileInner, tileCol);
+            for (int i {}; i < size; i++) {
+                double* accumulatorRow = accumulator + i * size;
+                for (int k {}; k < size; k++) {
+                    const double scalar = lhsTile[i * size + k];
+                    double const* rhsRow = rhsTile + k * size;
+                    for (int j {}; j < size; j++) {
+                        accumulatorRow[j] += scalar * rhsRow[j];
+                    }
+                }
+            }
+        }
+        std::copy(accumulator, accumulator + size * size, newTiledMatrix.tileData(tileRow, tileCol));
+    }, parallel);
+    return newTiledMatrix;
+}
+
+TiledMatrix transpose(TiledMatrix const& tm) {
+    TiledMatrix newTiledMatrix = TiledMatrix(tm.mNumCols, tm.mNumRows, tm.mOrder);
+    constexpr int size = TiledMatrix::tileSize;
+
+    // Tile (i, j) becomes tile (j, i), transposed within itself
+    for (int tileRow {}; tileRow < tm.mNumTileRows; tileRow++) {
+        for (int tileCol {}; tileCol < tm.mNumTileCols; tileCol++) {
+            double const* tile = tm.tileData(tileRow, tileCol);
+            double* newTile = newTiledMatrix.tileData(tileCol, tileRow);
+            for (int i {}; i < size; i++) {
+                for (int j {}; j < size; j++) {
+                    newTile[j * size + i] = tile[i * size + j];
+                }
+            }
+        }
+    }
+    return newTiledMatrix;
+}
+
+}  // namespace smallMatrix
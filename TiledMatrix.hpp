@@ -0,0 +1,166 @@
+/**
+ * @file TiledMatrix.hpp
+ * @author Mohamad Baydoun
+ * @brief Header file for TiledMatrix.cpp
+ */
+#pragma once
+
+#include "SmallMatrix.hpp"
+
+#include <utility>
+#include <vector>
+
+namespace smallMatrix {
+
+/**
+ * @brief The order in which the tiles of a TiledMatrix are stored.
+ */
+enum class TileOrder {
+    RowMajor,  // Tiles are stored row by row.
+    Morton     // Tiles are stored along a Z-order curve, so neighbouring tiles stay close.
+};
+
+class TiledMatrix {
+public:
+    /**
+     * @brief A constructor which initialises an empty matrix with no rows and no columns.
+     */
+    TiledMatrix();
+
+    /**
+     * @brief A constructor which initialises a zero matrix with the dimensions given by numRows
+     *        and numCols.
+     *
+     * @param numRows Number of rows to initialise with.
+     * @param numCols Number of columns to initialise with.
+     * @param order Order in which the tiles are stored.
+     * @throw Throws out_of_range if numRows or numCols is negative.
+     */
+    TiledMatrix(int numRows, int numCols, TileOrder order = TileOrder::Morton);
+
+    /**
+     * @brief A constructor which initialises a tiled copy of the specified matrix. Each row of a
+     *        tile is copied in one go.
+     *
+     * @param sm SmallMatrix to copy.
+     * @param order Order in which the tiles are stored.
+     */
+    explicit TiledMatrix(SmallMatrix const& sm, TileOrder order = TileOrder::Morton);
+
+    /**
+     * @brief Returns a row-major SmallMatrix holding the same elements.
+     *
+     * @return SmallMatrix
+     */
+    SmallMatrix toSmallMatrix() const;
+
+    /**
+     * @brief Returns the reference of the matrix element at the specified row and column index.
+     *
+     * @param numRow Row index.
+     * @param numCol Column index.
+     * @return double&
+     * @throw Throws out_of_range if the specified row and column is outside the range [0, max_row)
+     *        and [0, max_col) respectively.
+     */
+    double& operator()(int numRow, int numCol);
+
+    /**
+     * @brief Returns the constant reference of the matrix element at the specified row and column
+     *        index.
+     *
+     * @param numRow Row index.
+     * @param numCol Column index.
+     * @return const double&
+     * @throw Throws out_of_range if the specified row and column is outside the range [0, max_row)
+     *        and [0, max_col) respectively.
+     */
+    const double& operator()(int numRow, int numCol) const;
+
+    /**
+     * @brief Returns the size of the matrix where the first of the pair is the number of rows and
+     *        the second of the pair is the number of columns.
+     *
+     * @return std::pair<int, int>
+     */
+    std::pair<int, int> size() const;
+
+    /**
+     * @brief Returns the order in which the tiles are stored.
+     *
+     * @return TileOrder
+     */
+    TileOrder order() const;
+
+    /**
+     * @brief Returns the matrix result of the matrix multiplication of the two specified matrices,
+     *        computed one tile at a time. The result uses the tile order of the left-hand side.
+     *
+     * @param lhs Left-hand side matrix.
+     * @param rhs Right-hand side matrix.
+     * @return TiledMatrix
+     * @throw Throws invalid_argument if the number of columns on the left-hand side is not equal to
+     *        the number of rows on the right-hand side.
+     */
+    friend TiledMatrix operator*(TiledMatrix const& lhs, TiledMatrix const& rhs);
+
+    /**
+     * @brief Returns the matrix result of the matrix multiplication of the two specified matrices,
+     *        computed one tile at a time using the specified execution policy. The result uses the
+     *        tile order of the left-hand side.
+     *
+     * @param lhs Left-hand side matrix.
+     * @param rhs Right-hand side matrix.
+     * @param policy Execution policy of the multiplication.
+     * @return TiledMatrix
+     * @throw Throws invalid_argument if the number of columns on the left-hand side is not equal to
+     *        the number of rows on the right-hand side.
+     */
+    friend TiledMatrix multiply(TiledMatrix const& lhs, TiledMatrix const& rhs, ExecutionPolicy policy);
+
+    /**
+     * @brief Returns the result of the transpose on the specified matrix, computed one tile at a
+     *        time.
+     *
+     * @param tm Matrix to be transposed.
+     * @return TiledMatrix
+     */
+    friend TiledMatrix transpose(TiledMatrix const& tm);
+
+    static constexpr int tileSize = 32;
+
+private:
+    /**
+     * @brief Returns a pointer to the first element of the specified tile. Tiles are stored
+     *        contiguously in row-major order, and tiles on the bottom and right edges are padded
+     *        with zeros.
+     *
+     * @param tileRow Row index of the tile.
+     * @param tileCol Column index of the tile.
+     * @return double*
+     */
+    double* tileData(int tileRow, int tileCol);
+
+    /**
+     * @brief Returns a pointer to the first element of constant type of the specified tile.
+     *
+     * @param tileRow Row index of the tile.
+     * @param tileCol Column index of the tile.
+     * @return double const*
+     */
+    double const* tileData(int tileRow, int tileCol) const;
+
+    int mNumRows;
+    int mNumCols;
+    int mNumTileRows;
+    int mNumTileCols;
+    TileOrder mOrder;
+    std::vector<int> mTileSlots;
+    std::vector<double> mData;
+};
+
+// Forward declaring.
+TiledMatrix multiply(TiledMatrix const&, TiledMatrix const&, ExecutionPolicy);
+TiledMatrix transpose(TiledMatrix const&);
+
+}  // namespace smallMatrix
@@ -0,0 +1,353 @@
+/*
+Auto-tuner choosing the kernels, block sizes and parallel cutoffs of the Small Matrix program.
+*/
+
+#include "Tuner.hpp"
+#include "Executor.hpp"
+#include "SmallMatrix.hpp"
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+namespace smallMatrix {
+
+namespace {
+
+constexpr int cacheVersion = 1;
+
+// The parameters are read by every SmallMatrix operation. Each one is read and written atomically,
+// so they can be replaced while other threads are running operations.
+struct AtomicParameters {
+    std::atomic<int> multiplyBlockSize {TuningParameters().multiplyBlockSize};
+    std::atomic<MultiplyKernel> multiplyKernel {TuningParameters().multiplyKernel};
+    std::atomic<int> transposeBlockSize {TuningParameters().transposeBlockSize};
+    std::atomic<int> parallelThreshold {TuningParameters().parallelThreshold};
+    std::atomic<int> copyParallelThreshold {TuningParameters().copyParallelThreshold};
+    std::atomic<int> transposeParallelThreshold {TuningParameters().transposeParallelThreshold};
+    std::atomic<int> multiplyParallelThreshold {TuningParameters().multiplyParallelThreshold};
+};
+
+AtomicParameters currentParameters;
+std::once_flag firstUseFlag;
+
+// Set while the first use loads or tunes the parameters, so that operations run by the tuner on the
+// same thread read the defaults instead of waiting for themselves
+thread_local bool isFirstUse {false};
+
+TuningParameters loadCurrentParameters() {
+    TuningParameters parameters;
+    parameters.multiplyBlockSize = currentParameters.multiplyBlockSize.load(std::memory_order_relaxed);
+    parameters.multiplyKernel = currentParameters.multiplyKernel.load(std::memory_order_relaxed);
+    parameters.transposeBlockSize = currentParameters.transposeBlockSize.load(std::memory_order_relaxed);
+    parameters.parallelThreshold = currentParameters.parallelThreshold.load(std::memory_order_relaxed);
+    parameters.copyParallelThreshold = currentParameters.copyParallelThreshold.load(std::memory_order_relaxed);
+    parameters.transposeParallelThreshold = currentParameters.transposeParallelThreshold.load(std::memory_order_relaxed);
+    parameters.multiplyParallelThreshold = currentParameters.multiplyParallelThreshold.load(std::memory_order_relaxed);
+    return parameters;
+}
+
+void storeCurrentParameters(TuningParameters const& parameters) {
+    if (parameters.multiplyBlockSize <= 0 || parameters.transposeBlockSize <= 0 ||
+        parameters.parallelThreshold <= 0 || parameters.copyParallelThreshold <= 0 ||
+        parameters.transposeParallelThreshold <= 0 || parameters.multiplyParallelThreshold <= 0) {
+        throw std::invalid_argument("Block sizes and parallel cutoffs must be positive!");
+    }
+    currentParameters.multiplyBlockSize.store(parameters.multiplyBlockSize, std::memory_order_relaxed);
+    currentParameters.multiplyKernel.store(parameters.multiplyKernel, std::memory_order_relaxed);
+    currentParameters.transposeBlockSize.store(parameters.transposeBlockSize, std::memory_order_relaxed);
+    currentParameters.parallelThreshold.store(parameters.parallelThreshold, std::memory_order_relaxed);
+    currentParameters.copyParallelThreshold.store(parameters.copyParallelThreshold, std::memory_order_relaxed);
+    currentParameters.transposeParallelThreshold.store(parameters.transposeParallelThreshold, std::memory_order_relaxed);
+    currentParameters.multiplyParallelThreshold.store(parameters.multiplyParallelThreshold, std::memory_order_relaxed);
+}
+
+// Returns the name of this host and its number of hardware threads, which a cache must match
+std::string hostSignature() {
+    char hostName[256] {};
+    if (gethostname(hostName, sizeof(hostName) - 1) != 0) {
+        hostName[0] = '\0';
+    }
+    return std::string(hostName[0] == '\0' ? "unknown" : hostName) + " " +
+           std::to_string(Executor::instance().numThreads());
+}
+
+bool readParameters(std::string const& path, TuningParameters& parameters) {
+    std::ifstream file(path);
+    std::string key;
+    int version {};
+    if (!(file >> key >> version) || key != "small_matrix_tuning" || version != cacheVersion) {
+        return false;
+    }
+
+    std::string hostName;
+    std::string numThreads;
+    if (!(file >> key >> hostName >> numThreads) || key != "host" || hostName + " " + numThreads != hostSignature()) {
+        return false;
+    }
+
+    std::string kernel;
+    if (!(file >> key >> parameters.multiplyBlockSize) || key != "multiplyBlockSize" ||
+        !(file >> key >> kernel) || key != "multiplyKernel" ||
+        !(file >> key >> parameters.transposeBlockSize) || key != "transposeBlockSize" ||
+        !(file >> key >> parameters.parallelThreshold) || key != "parallelThreshold" ||
+        !(file >> key >> parameters.copyParallelThreshold) || key != "copyParallelThreshold" ||
+        !(file >> key >> parameters.transposeParallelThreshold) || key != "transposeParallelThreshold" ||
+        !(file >> key >> parameters.multiplyParallelThreshold) || key != "multiplyParallelThreshold") {
+        return false;
+    }
+    if (kernel != "Blocked" && kernel != "RegisterTiled") {
+        return false;
+    }
+    parameters.multiplyKernel = kernel == "Blocked" ? MultiplyKernel::Blocked : MultiplyKernel::RegisterTiled;
+    return true;
+}
+
+// Returns the fastest of several runs of the operation, in seconds
+double timeOperation(std::function<void()> const& operation) {
+    const int numRuns = 3;
+    double best {std::numeric_limits<double>::max()};
+    for (int run {}; run < numRuns; run++) {
+        auto const start = std::chrono::steady_clock::now();
+        operation();
+        auto const stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(stop - start).count());
+    }
+    return best;
+}
+
+// Returns the smallest amount of work from which running on several threads was faster at every
+// larger size measured. makeOperation(n) sets up the operands of size n and returns the operation
+// on them, so that only operation(parallel) is timed.
+int measureParallelCutoff(std::vector<int> const& sizes, std::function<long long(int)> const& work,
+                          std::function<std::function<void(bool)>(int)> const& makeOperation) {
+    int cutoff {std::numeric_limits<int>::max()};
+    for (auto n = sizes.crbegin(); n != sizes.crend(); n++) {
+        const std::function<void(bool)> operation = makeOperation(*n);
+        const double sequential = timeOperation([&]() { operation(false); });
+        const double parallel = timeOperation([&]() { operation(true); });
+        if (parallel >= sequential) {
+            break;
+        }
+        cutoff = static_cast<int>(std::min<long long>(work(*n), std::numeric_limits<int>::max()));
+    }
+    return cutoff;
+}
+
+// Creates the directory holding the specified file, if it does not exist. Only the last directory
+// is created, as for the per-user cache directory.
+void createParentDirectory(std::string const& path) {
+    const std::string::size_type separator = path.find_last_of('/');
+    if (separator != std::string::npos && separator != 0) {
+        mkdir(path.substr(0, separator).c_str(), 0700);
+    }
+}
+
+// Loads the cache on first use. Without a cache for this host, the parameters are tuned and the
+// cache is written only if SMALL_MATRIX_AUTOTUNE is 1; otherwise the defaults are kept.
+void initialiseParameters() {
+    isFirstUse = true;
+    try {
+        const std::string path = Tuner::cachePath();
+        char const* autotune = std::getenv("SMALL_MATRIX_AUTOTUNE");
+        const bool isLoaded = !path.empty() && Tuner::load(path);
+        if (!isLoaded && autotune != nullptr && std::string(autotune) == "1") {
+            Tuner::tune();
+            if (!path.empty()) {
+                try {
+                    createParentDirectory(path);
+                    Tuner::save(path);
+                } catch (std::runtime_error const&) {
+                    // Without a writable cache the next process tunes again
+                }
+            }
+        }
+    } catch (...) {
+        isFirstUse = false;
+        throw;
+    }
+    isFirstUse = false;
+}
+
+// Marks the first use as done, so that parameters set explicitly are not replaced afterwards
+void skipFirstUse() {
+    if (!isFirstUse) {
+        std::call_once(firstUseFlag, []() {});
+    }
+}
+
+}  // namespace
+
+TuningParameters Tuner::parameters() {
+    if (!isFirstUse) {
+        std::call_once(firstUseFlag, initialiseParameters);
+    }
+    return loadCurrentParameters();
+}
+
+void Tuner::setParameters(TuningParameters const& parameters) {
+    skipFirstUse();
+    storeCurrentParameters(parameters);
+}
+
+TuningParameters Tuner::tune() {
+    skipFirstUse();
+    TuningParameters tuned = measureParameters();
+    storeCurrentParameters(tuned);
+    return tuned;
+}
+
+bool Tuner::load(std::string const& path) {
+    skipFirstUse();
+    TuningParameters parameters;
+    if (!readParameters(path, parameters)) {
+        return false;
+    }
+    try {
+        storeCurrentParameters(parameters);
+    } catch (std::invalid_argument const&) {
+        return false;
+    }
+    return true;
+}
+
+void Tuner::save(std::string const& path) {
+    const TuningParameters parameters = loadCurrentParameters();
+    std::ofstream file(path);
+    file << "small_matrix_tuning " << cacheVersion << '\n'
+         << "host " << hostSignature() << '\n'
+         << "multiplyBlockSize " << parameters.multiplyBlockSize << '\n'
+         << "multiplyKernel " << (parameters.multiplyKernel == MultiplyKernel::Blocked ? "Blocked" : "RegisterTiled") << '\n'
+         << "transposeBlockSize " << parameters.transposeBlockSize << '\n'
+         << "parallelThreshold " << parameters.parallelThreshold << '\n'
+         << "copyParallelThreshold " << parameters.copyParallelThreshold << '\n'
+         << "transposeParallelThreshold " << parameters.transposeParallelThreshold << '\n'
+         << "multiplyParallelThreshold " << parameters.multiplyParallelThreshold << '\n';
+    file.close();
+    if (!file) {
+        throw std::runtime_error("Could not write tuning cache!");
+    }
+}
+
+TuningParameters Tuner::measureParameters() {
+    TuningParameters tuned;
+
+    // Kernel and block size of multiplication, measured on one thread on matrices that do not fit
+    // in the first-level cache
+    {
+        const int n = 192;
+        SmallMatrix lhs = SmallMatrix(n, n, 1.0);
+        SmallMatrix rhs = SmallMatrix(n, n, 0.5);
+        SmallMatrix out = SmallMatrix(n, n, 0.0);
+        double best {std::numeric_limits<double>::max()};
+        for (auto kernel : {MultiplyKernel::Blocked, MultiplyKernel::RegisterTiled}) {
+            for (int blockSize : {16, 32, 64, 128}) {
+                const double elapsed = timeOperation([&]() {
+                    SmallMatrix::multiplyKernel(lhs, rhs, out.block(0, 0, n, n), blockSize, kernel, false);
+                });
+                if (elapsed < best) {
+                    best = elapsed;
+                    tuned.multiplyBlockSize = blockSize;
+                    tuned.multiplyKernel = kernel;
+                }
+            }
+        }
+    }
+
+    // Tile size of transpose
+    {
+        const int n = 768;
+        SmallMatrix block = SmallMatrix(n, n, 1.0);
+        SmallMatrix out = SmallMatrix(n, n);
+        double best {std::numeric_limits<double>::max()};
+        for (int tileSize : {8, 16, 32, 64, 128}) {
+            const double elapsed = timeOperation([&]() { SmallMatrix::transposeKernel(block, out, tileSize, false); });
+            if (elapsed < best) {
+                best = elapsed;
+                tuned.transposeBlockSize = tileSize;
+            }
+        }
+    }
+
+    // With a single thread, splitting an operation never pays off
+    if (Executor::instance().numThreads() <= 1) {
+        tuned.parallelThreshold = std::numeric_limits<int>::max();
+        tuned.copyParallelThreshold = std::numeric_limits<int>::max();
+        tuned.transposeParallelThreshold = std::numeric_limits<int>::max();
+        tuned.multiplyParallelThreshold = std::numeric_limits<int>::max();
+        return tuned;
+    }
+
+    const std::vector<int> sizes {64, 128, 256, 512, 1024};
+    auto const elements = [](int n) { return static_cast<long long>(n) * n; };
+    auto const policyOf = [](bool parallel) { return parallel ? ExecutionPolicy::ThreadPool : ExecutionPolicy::Sequential; };
+
+    // The copy cutoff is used by the copy constructor, which allocates and fills each row on the
+    // thread that copies it, so the allocation is part of the measured copy
+    tuned.copyParallelThreshold = measureParallelCutoff(sizes, elements, [&](int n) {
+        auto const source = std::make_shared<SmallMatrix>(n, n, 1.0);
+        return [source, policyOf](bool parallel) {
+            SmallMatrix copy(*source, policyOf(parallel));
+        };
+    });
+
+    tuned.parallelThreshold = measureParallelCutoff(sizes, elements, [&](int n) {
+        auto const sm = std::make_shared<SmallMatrix>(n, n, 1.0);
+        auto const partialSums = std::make_shared<std::vector<double>>(n);
+        return [sm, partialSums, policyOf, n](bool parallel) {
+            sm->forEachRowChunk([&](int firstRow, int lastRow) {
+                for (int i {firstRow}; i < lastRow; i++) {
+                    (*partialSums)[i] = std::accumulate(sm->rowData(i), sm->rowData(i) + n, 0.0);
+                }
+            }, policyOf(parallel), 0);
+        };
+    });
+
+    tuned.transposeParallelThreshold = measureParallelCutoff(sizes, elements, [&](int n) {
+        auto const block = std::make_shared<SmallMatrix>(n, n, 1.0);
+        auto const out = std::make_shared<SmallMatrix>(n, n);
+        const int tileSize = tuned.transposeBlockSize;
+        return [block, out, tileSize](bool parallel) {
+            SmallMatrix::transposeKernel(*block, *out, tileSize, parallel);
+        };
+    });
+
+    tuned.multiplyParallelThreshold = measureParallelCutoff(
+        {64, 96, 128, 192, 256}, [](int n) { return static_cast<long long>(n) * n * n; }, [&](int n) {
+            auto const lhs = std::make_shared<SmallMatrix>(n, n, 1.0);
+            auto const out = std::make_shared<SmallMatrix>(n, n, 0.0);
+            const int blockSize = tuned.multiplyBlockSize;
+            const MultiplyKernel kernel = tuned.multiplyKernel;
+            return [lhs, out, blockSize, kernel, n](bool parallel) {
+                SmallMatrix::multiplyKernel(*lhs, *lhs, out->block(0, 0, n, n), blockSize, kernel, parallel);
+            };
+        });
+    return tuned;
+}
+
+std::string Tuner::cachePath() {
+    char const* path = std::getenv("SMALL_MATRIX_TUNING_CACHE");
+    if (path != nullptr) {
+        return path;
+    }
+    char const* cacheHome = std::getenv("XDG_CACHE_HOME");
+    if (cacheHome != nullptr && cacheHome[0] == '/') {
+        return std::string(cacheHome) + "/small_matrix_tuning";
+    }
+    char const* home = std::getenv("HOME");
+    if (home != nullptr && home[0] != '\0') {
+        return std::string(home) + "/.cache/small_matrix_tuning";
+    }
+    return "";
+}
+
+}  // namespace smallMatrix
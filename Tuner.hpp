@@ -0,0 +1,105 @@
+/**
+ * @file Tuner.hpp
+ * @author Mohamad Baydoun
+ * @brief Header file for Tuner.cpp
+ */
+#pragma once
+
+#include <string>
+
+namespace smallMatrix {
+
+/**
+ * @brief Inner kernel used by matrix multiplication. Both kernels add the products for each
+ *        element in the same order, so they give identical results and only differ in speed.
+ *
+ * Blocked streams one row of the left-hand side at a time through a block of the right-hand side.
+ * RegisterTiled updates four rows of the output for every row of the right-hand side it loads.
+ */
+enum class MultiplyKernel { Blocked, RegisterTiled };
+
+/**
+ * @brief Kernel choices, block sizes and parallel cutoffs used by SmallMatrix operations. The
+ *        cutoffs are the amount of work from which ExecutionPolicy::Parallel uses several threads:
+ *        elements for element-wise operations and transpose, multiply-adds for multiplication.
+ *        The default cutoffs are placeholder powers of two that have not been benchmarked; use
+ *        Tuner::tune() or benchmark.cpp to find the values for a given host.
+ */
+struct TuningParameters {
+    int multiplyBlockSize {64};
+    MultiplyKernel multiplyKernel {MultiplyKernel::Blocked};
+    int transposeBlockSize {32};
+    int parallelThreshold {1 << 16};
+    int copyParallelThreshold {1 << 18};
+    int transposeParallelThreshold {1 << 17};
+    int multiplyParallelThreshold {1 << 18};
+};
+
+class Tuner {
+public:
+    /**
+     * @brief Returns the parameters currently used by SmallMatrix operations. On first use, the
+     *        parameters are loaded from the cache file at cachePath(). If there is no cache for
+     *        this host, the defaults are used, unless the SMALL_MATRIX_AUTOTUNE environment
+     *        variable is set to 1, in which case the kernels are tuned and the result is written
+     *        to the cache.
+     *
+     * @return TuningParameters
+     */
+    static TuningParameters parameters();
+
+    /**
+     * @brief Replaces the parameters used by SmallMatrix operations from now on.
+     *
+     * @param parameters New parameters.
+     * @throw Throws invalid_argument if a block size or cutoff is not positive.
+     */
+    static void setParameters(TuningParameters const& parameters);
+
+    /**
+     * @brief Micro-benchmarks the multiply, transpose and element-wise kernels on this host, uses
+     *        the fastest kernel, block sizes and parallel cutoffs from now on and returns them. The
+     *        result is not written to the cache; call save() to keep it.
+     *
+     * @return TuningParameters
+     */
+    static TuningParameters tune();
+
+    /**
+     * @brief Loads and uses the parameters in the specified cache file, if it was written on this
+     *        host by the same version of the tuner.
+     *
+     * @param path Path of the cache file.
+     * @return true, if the parameters were loaded.
+     * @return false, if the file is missing, was written on another host or is malformed.
+     */
+    static bool load(std::string const& path);
+
+    /**
+     * @brief Writes the current parameters to the specified cache file, tagged with this host.
+     *
+     * @param path Path of the cache file.
+     * @throw Throws runtime_error if the file cannot be written.
+     */
+    static void save(std::string const& path);
+
+    /**
+     * @brief Returns the path of the cache file. This is the value of the
+     *        SMALL_MATRIX_TUNING_CACHE environment variable if it is set, and otherwise
+     *        small_matrix_tuning in $XDG_CACHE_HOME, or in $HOME/.cache if XDG_CACHE_HOME is not
+     *        set to an absolute path.
+     *
+     * @return std::string, which is empty if none of the variables is set.
+     */
+    static std::string cachePath();
+
+private:
+    /**
+     * @brief Runs the micro-benchmarks and returns the fastest parameters, without using them.
+     *
+     * @return TuningParameters
+     */
+    static TuningParameters measureParameters();
+};
+
+}  // namespace smallMatrix
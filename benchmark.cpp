@@ -0,0 +1,96 @@
+/*
+Benchmark measuring where splitting bulk SmallMatrix operations across threads pays off.
+*/
+
+#include "SmallMatrix.hpp"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace smallMatrix;
+
+namespace {
+
+// Returns the fastest of several runs of the operation, in microseconds
+double timeOperation(std::function<void()> const& operation) {
+    const int numRuns = 5;
+    double best {};
+    for (int run {}; run < numRuns; run++) {
+        auto const start = std::chrono::steady_clock::now();
+        operation();
+        auto const stop = std::chrono::steady_clock::now();
+        const double elapsed = std::chrono::duration<double, std::micro>(stop - start).count();
+        best = run == 0 ? elapsed : std::min(best, elapsed);
+    }
+    return best;
+}
+
+// Runs the operation sequentially and on the thread pool for square matrices of every size, and
+// reports the smallest amount of work from which the thread pool is faster at every larger size
+void benchmark(std::string const& name, std::vector<int> const& sizes, std::function<long long(int)> const& work,
+               std::function<void(SmallMatrix const&, SmallMatrix const&, ExecutionPolicy)> const& operation) {
+    std::cout << name << '\n';
+    std::cout << std::setw(8) << "size" << std::setw(14) << "work" << std::setw(16) << "sequential us"
+              << std::setw(16) << "thread pool us" << '\n';
+
+    long long cutoff {-1};
+    for (int n : sizes) {
+        SmallMatrix lhs = SmallMatrix(n, n, 1.0);
+        SmallMatrix rhs = SmallMatrix(n, n, 2.0);
+        const double sequential = timeOperation([&]() { operation(lhs, rhs, ExecutionPolicy::Sequential); });
+        const double threadPool = timeOperation([&]() { operation(lhs, rhs, ExecutionPolicy::ThreadPool); });
+        std::cout << std::setw(8) << n << std::setw(14) << work(n) << std::fixed << std::setprecision(1)
+                  << std::setw(16) << sequential << std::setw(16) << threadPool << '\n';
+
+        if (threadPool >= sequential) {
+            cutoff = -1;
+        } else if (cutoff < 0) {
+            cutoff = work(n);
+        }
+    }
+
+    if (cutoff < 0) {
+        std::cout << "cutoff: the thread pool was not faster at the largest size\n\n";
+    } else {
+        std::cout << "cutoff: " << cutoff << '\n' << '\n';
+    }
+}
+
+}  // namespace
+
+int main() {
+    const std::vector<int> sizes {64, 128, 256, 362, 512, 724, 1024, 1448, 2048};
+    const std::vector<int> multiplySizes {16, 32, 64, 100, 128, 160, 256, 512};
+    auto const elements = [](int n) { return static_cast<long long>(n) * n; };
+    auto const multiplyAdds = [](int n) { return static_cast<long long>(n) * n * n; };
+
+    benchmark("copy construction", sizes, elements, [](SmallMatrix const& lhs, SmallMatrix const&, ExecutionPolicy policy) {
+        SmallMatrix copy(lhs, policy);
+    });
+    benchmark("resize", sizes, elements, [](SmallMatrix const& lhs, SmallMatrix const&, ExecutionPolicy policy) {
+        SmallMatrix resized;
+        resized.resize(lhs.size().first, lhs.size().second, policy);
+    });
+    benchmark("equals", sizes, elements, [](SmallMatrix const& lhs, SmallMatrix const&, ExecutionPolicy policy) {
+        equals(lhs, lhs, policy);
+    });
+    benchmark("add", sizes, elements, [](SmallMatrix const& lhs, SmallMatrix const& rhs, ExecutionPolicy policy) {
+        add(lhs, rhs, policy);
+    });
+    benchmark("scalar multiply", sizes, elements, [](SmallMatrix const& lhs, SmallMatrix const&, ExecutionPolicy policy) {
+        multiply(2.0, lhs, policy);
+    });
+    benchmark("sum", sizes, elements, [](SmallMatrix const& lhs, SmallMatrix const&, ExecutionPolicy policy) {
+        lhs.sum(policy);
+    });
+    benchmark("transpose", sizes, elements, [](SmallMatrix const& lhs, SmallMatrix const&, ExecutionPolicy policy) {
+        transpose(lhs, policy);
+    });
+    benchmark("multiply", multiplySizes, multiplyAdds, [](SmallMatrix const& lhs, SmallMatrix const& rhs, ExecutionPolicy policy) {
+        multiply(lhs, rhs, policy);
+    });
+}
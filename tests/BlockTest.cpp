@@ -0,0 +1,99 @@
+/*
+Tests for block views and block assignment.
+*/
+
+#include "SmallMatrix.hpp"
+#include "tests/Check.hpp"
+#include "tests/Fixtures.hpp"
+#include <stdexcept>
+#include <utility>
+
+using namespace smallMatrix;
+
+namespace {
+
+void testViews() {
+    SmallMatrix sm = patternMatrix(6, 6, 0);
+    SmallMatrix const& constSm = sm;
+    auto block = constSm.block(1, 2, 3, 2);
+    CHECK(block.size() == std::make_pair(3, 2));
+    CHECK(block(0, 0) == sm(1, 2));
+
+    SmallMatrix copy(block);
+    CHECK(copy.size() == std::make_pair(3, 2));
+    CHECK(copy(2, 1) == sm(3, 3));
+
+    // A view refers to the elements of the matrix rather than a copy of them
+    sm(1, 2) = 42.0;
+    CHECK(block(0, 0) == 42.0);
+
+    CHECK_THROWS(sm.block(5, 5, 2, 1), std::out_of_range);
+    CHECK_THROWS(sm.block(-1, 0, 1, 1), std::out_of_range);
+    CHECK_THROWS(block(3, 0), std::out_of_range);
+}
+
+void testArithmetic() {
+    SmallMatrix sm = patternMatrix(6, 6, 0);
+    SmallMatrix topLeft(sm.block(0, 0, 2, 3));
+    SmallMatrix bottomRight(sm.block(3, 3, 3, 2));
+
+    CHECK(sm.block(1, 2, 3, 2) + sm.block(1, 2, 3, 2) == 2.0 * SmallMatrix(sm.block(1, 2, 3, 2)));
+    SmallMatrix difference = sm.block(0, 0, 2, 2) - sm.block(2, 2, 2, 2);
+    CHECK(difference(1, 1) == sm(1, 1) - sm(3, 3));
+    CHECK(sm.block(0, 0, 2, 3) * sm.block(3, 3, 3, 2) == topLeft * bottomRight);
+    CHECK(transpose(sm.block(1, 2, 3, 2)) == transpose(SmallMatrix(sm.block(1, 2, 3, 2))));
+
+    SmallMatrix large = patternMatrix(200, 170, 0);
+    SmallMatrix transposed = transpose(large.block(0, 0, 200, 170));
+    CHECK(transposed == transpose(large));
+    CHECK(transposed(3, 150) == large(150, 3));
+
+    SmallMatrix out = SmallMatrix(2, 2, 1.0);
+    multiplyAdd(sm.block(0, 0, 2, 3), sm.block(3, 3, 3, 2), out.block(0, 0, 2, 2));
+    CHECK(out == topLeft * bottomRight + SmallMatrix(2, 2, 1.0));
+    CHECK_THROWS(multiplyAdd(sm.block(0, 0, 2, 2), sm.block(0, 0, 2, 2), sm.block(1, 1, 2, 2)), std::invalid_argument);
+    CHECK_THROWS(sm.block(0, 0, 2, 3) * sm.block(0, 0, 2, 3), std::invalid_argument);
+}
+
+// Overlapping source and destination blocks are copied as if through a temporary
+void testAssignment() {
+    SmallMatrix sm = patternMatrix(6, 6, 0);
+    SmallMatrix shiftedUp = sm;
+    shiftedUp.block(0, 0, 3, 3) = shiftedUp.block(1, 1, 3, 3);
+    SmallMatrix shiftedDown = sm;
+    shiftedDown.block(1, 1, 3, 3) = shiftedDown.block(0, 0, 3, 3);
+    for (int i {}; i < 3; i++) {
+        for (int j {}; j < 3; j++) {
+            CHECK(shiftedUp(i, j) == sm(i + 1, j + 1));
+            CHECK(shiftedDown(i + 1, j + 1) == sm(i, j));
+        }
+    }
+
+    SmallMatrix accumulated = sm;
+    accumulated.block(0, 0, 2, 2) += sm.block(4, 4, 2, 2);
+    accumulated.block(0, 0, 2, 2) -= sm.block(4, 4, 2, 2);
+    CHECK(accumulated == sm);
+    accumulated.block(2, 2, 2, 2) *= 3.0;
+    CHECK(accumulated(3, 3) == 3.0 * sm(3, 3) && accumulated(4, 4) == sm(4, 4));
+    CHECK_THROWS(accumulated.block(0, 0, 2, 2) += sm, std::invalid_argument);
+    CHECK_THROWS(accumulated.block(0, 0, 2, 2) = sm.block(0, 0, 3, 3), std::invalid_argument);
+}
+
+// Writing through a block detaches a shared copy-on-write buffer
+void testCopyOnWrite() {
+    SmallMatrix shared = SmallMatrix(20, 20, 1.0);
+    shared.setCopyOnWrite(true);
+    SmallMatrix copy = shared;
+    copy.block(0, 0, 2, 2) *= 3.0;
+    CHECK(shared(0, 0) == 1.0);
+    CHECK(copy(0, 0) == 3.0);
+}
+
+}  // namespace
+
+int main() {
+    testViews();
+    testArithmetic();
+    testAssignment();
+    testCopyOnWrite();
+}
@@ -0,0 +1,34 @@
+/**
+ * @file Check.hpp
+ * @author Mohamad Baydoun
+ * @brief Assertion macros shared by the tests.
+ */
+#pragma once
+
+#include <cstdlib>
+#include <iostream>
+
+/**
+ * @brief Reports the failed condition with its location and exits with a non-zero status.
+ */
+#define CHECK(condition)                                                                        \
+    do {                                                                                        \
+        if (!(condition)) {                                                                     \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #condition ") failed\n";     \
+            std::exit(EXIT_FAILURE);                                                            \
+        }                                                                                       \
+    } while (false)
+
+/**
+ * @brief Checks that evaluating the expression throws the specified exception type.
+ */
+#define CHECK_THROWS(expression, exceptionType)                                                 \
+    do {                                                                                        \
+        bool isThrown {false};                                                                  \
+        try {                                                                                   \
+            static_cast<void>(expression);                                                      \
+        } catch (exceptionType const&) {                                                        \
+            isThrown = true;                                                                    \
+        }                                                                                       \
+        CHECK(isThrown && #expression " throws " #exceptionType);                               \
+    } while (false)
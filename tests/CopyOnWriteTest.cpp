@@ -0,0 +1,144 @@
+/*
+Tests for copy-on-write sharing of heap buffers.
+*/
+
+#include "SmallMatrix.hpp"
+#include "tests/Check.hpp"
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace smallMatrix;
+
+namespace {
+
+double const& constElement(SmallMatrix const& sm, int numRow, int numCol) {
+    return sm(numRow, numCol);
+}
+
+void testCopiesShareUntilWritten() {
+    SmallMatrix original = SmallMatrix(50, 50, 1.0);
+    CHECK(!original.isCopyOnWrite());
+    original.setCopyOnWrite(true);
+    CHECK(original.isCopyOnWrite());
+
+    SmallMatrix copy(original);
+    CHECK(copy.isCopyOnWrite());
+    CHECK(&constElement(copy, 0, 0) == &constElement(original, 0, 0));
+
+    copy(0, 0) = 5.0;
+    CHECK(&constElement(copy, 0, 0) != &constElement(original, 0, 0));
+    CHECK(original(0, 0) == 1.0);
+    CHECK(copy(0, 0) == 5.0);
+
+    // The sole owner writes in place
+    double const* element = &constElement(copy, 1, 1);
+    copy(1, 1) = 6.0;
+    CHECK(&constElement(copy, 1, 1) == element);
+}
+
+void testStructuralChangesDetach() {
+    SmallMatrix original = SmallMatrix(50, 50, 1.0);
+    original.setCopyOnWrite(true);
+
+    SmallMatrix resized;
+    resized = original;
+    resized.resize(60, 60);
+    CHECK(original.size() == std::make_pair(50, 50));
+    CHECK(resized(0, 0) == 1.0 && resized(59, 59) == 0.0);
+
+    SmallMatrix inserted(original);
+    inserted.insertRow(0, std::vector<double>(50, 2.0));
+    inserted.eraseCol(3);
+    CHECK(inserted.size() == std::make_pair(51, 49));
+    CHECK(original.size() == std::make_pair(50, 50) && original(0, 3) == 1.0);
+
+    SmallMatrix small = SmallMatrix(2, 2, 1.0);
+    small.setCopyOnWrite(true);
+    SmallMatrix smallCopy = small;
+    smallCopy(0, 0) = 9.0;
+    CHECK(small(0, 0) == 1.0);
+}
+
+// Small matrices are copied by value, even when copied from a large matrix that has shrunk
+void testSmallCopiesDoNotShare() {
+    SmallMatrix small = SmallMatrix(2, 2, 1.0);
+    small.setCopyOnWrite(true);
+    CHECK(!small.isCopyOnWrite());
+
+    SmallMatrix shrunk = SmallMatrix(50, 50, 1.0);
+    shrunk.setCopyOnWrite(true);
+    shrunk.resize(3, 3);
+    CHECK(!shrunk.isSmall() && shrunk.isCopyOnWrite());
+
+    SmallMatrix copy(shrunk);
+    SmallMatrix assigned = SmallMatrix(50, 50);
+    assigned.setCopyOnWrite(true);
+    assigned = shrunk;
+    CHECK(copy.isSmall() && !copy.isCopyOnWrite());
+    CHECK(assigned.isSmall() && !assigned.isCopyOnWrite());
+    CHECK(copy == shrunk && assigned == shrunk);
+
+    // The shrunk matrix is still the sole owner of its buffer, so it writes in place
+    double const* element = &constElement(shrunk, 1, 1);
+    shrunk(1, 1) = 6.0;
+    CHECK(&constElement(shrunk, 1, 1) == element);
+    CHECK(copy(1, 1) == 1.0 && assigned(1, 1) == 1.0);
+}
+
+void testDisableAndMove() {
+    SmallMatrix original = SmallMatrix(50, 50, 1.0);
+    original.setCopyOnWrite(true);
+    SmallMatrix copy(original);
+
+    original.setCopyOnWrite(false);
+    CHECK(!original.isCopyOnWrite());
+    original(3, 3) = 7.0;
+    CHECK(copy(3, 3) == 1.0);
+
+    SmallMatrix moved(std::move(copy));
+    CHECK(moved.isCopyOnWrite());
+    CHECK(moved(3, 3) == 1.0);
+    moved.setCopyOnWrite(false);
+    CHECK(moved == SmallMatrix(50, 50, 1.0));
+}
+
+// Every thread copies the shared matrix and writes to its own copy, so the buffer is detached and
+// released concurrently with the reads of the other threads
+void testConcurrentCopies() {
+    SmallMatrix original = SmallMatrix(40, 40, 1.0);
+    original.setCopyOnWrite(true);
+
+    std::vector<std::thread> threads;
+    std::vector<int> isCorrect(4, 0);
+    for (int t {}; t < 4; t++) {
+        threads.emplace_back([&original, &isCorrect, t] {
+            bool correct {true};
+            for (int round {}; round < 200; round++) {
+                SmallMatrix copy(original);
+                copy(t, round % 40) = t + 2.0;
+                SmallMatrix other(copy);
+                other(0, 0) += 1.0;
+                correct = correct && copy(t, round % 40) == t + 2.0 && constElement(original, t, round % 40) == 1.0;
+            }
+            isCorrect.at(t) = correct;
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    for (int correct : isCorrect) {
+        CHECK(correct);
+    }
+    CHECK(original == SmallMatrix(40, 40, 1.0));
+}
+
+}  // namespace
+
+int main() {
+    testCopiesShareUntilWritten();
+    testStructuralChangesDetach();
+    testSmallCopiesDoNotShare();
+    testDisableAndMove();
+    testConcurrentCopies();
+}
@@ -0,0 +1,131 @@
+/*
+Tests that every execution policy of the bulk operations gives the same result.
+*/
+
+#include "SmallMatrix.hpp"
+#include "tests/Check.hpp"
+#include "tests/Fixtures.hpp"
+#include <utility>
+#include <vector>
+
+using namespace smallMatrix;
+
+namespace {
+
+const std::vector<ExecutionPolicy> policies {
+    ExecutionPolicy::Sequential, ExecutionPolicy::Parallel, ExecutionPolicy::ThreadPool};
+
+// Small, large and large enough to be split across threads by the Parallel policy
+const std::vector<std::pair<int, int>> shapes {{3, 4}, {130, 70}, {700, 800}};
+
+void testZeroInitialised() {
+    // Leave non-zero values on the stack where the next matrix is constructed
+    {
+        SmallMatrix previous = SmallMatrix(11, 13, 7.0);
+        CHECK(previous(10, 12) == 7.0);
+    }
+    SmallMatrix sm = SmallMatrix(11, 13);
+    for (int i {}; i < 11; i++) {
+        for (int j {}; j < 13; j++) {
+            CHECK(sm(i, j) == 0.0);
+        }
+    }
+}
+
+void testFreeFunctions() {
+    for (auto const& shape : shapes) {
+        const int rows = shape.first;
+        const int cols = shape.second;
+        SmallMatrix lhs = patternMatrix(rows, cols, 1);
+        SmallMatrix rhs = patternMatrix(rows, cols, 2);
+        SmallMatrix multiplier = patternMatrix(cols, rows, 3);
+
+        SmallMatrix sum = add(lhs, rhs, ExecutionPolicy::Sequential);
+        SmallMatrix difference = subtract(lhs, rhs, ExecutionPolicy::Sequential);
+        SmallMatrix product = multiply(lhs, multiplier, ExecutionPolicy::Sequential);
+        SmallMatrix scaled = multiply(2.5, lhs, ExecutionPolicy::Sequential);
+        SmallMatrix transposed = transpose(lhs, ExecutionPolicy::Sequential);
+        for (ExecutionPolicy policy : policies) {
+            CHECK(add(lhs, rhs, policy) == sum);
+            CHECK(subtract(lhs, rhs, policy) == difference);
+            CHECK(multiply(lhs, multiplier, policy) == product);
+            CHECK(multiply(2.5, lhs, policy) == scaled);
+            CHECK(transpose(lhs, policy) == transposed);
+            CHECK(equals(lhs, lhs, policy));
+            CHECK(!equals(lhs, rhs, policy));
+
+            SmallMatrix accumulated = SmallMatrix(rows, rows, 1.0);
+            multiplyAdd(lhs, multiplier, accumulated, policy);
+            CHECK(accumulated == product + SmallMatrix(rows, rows, 1.0));
+        }
+        CHECK(lhs + rhs == sum);
+        CHECK(lhs - rhs == difference);
+        CHECK(lhs * multiplier == product);
+    }
+}
+
+void testCopyAndResize() {
+    for (auto const& shape : shapes) {
+        const int rows = shape.first;
+        const int cols = shape.second;
+        SmallMatrix sm = patternMatrix(rows, cols, 4);
+        for (ExecutionPolicy policy : policies) {
+            SmallMatrix copy(sm, policy);
+            CHECK(copy == sm);
+
+            SmallMatrix assigned = patternMatrix(rows + 3, cols + 2, 5);
+            CHECK(&assigned.assign(sm, policy) == &assigned);
+            CHECK(assigned == sm);
+
+            SmallMatrix resized = sm;
+            resized.resize(rows + 5, cols + 9, policy);
+            for (int i {}; i < rows + 5; i++) {
+                for (int j {}; j < cols + 9; j++) {
+                    CHECK(resized(i, j) == (i < rows && j < cols ? sm(i, j) : 0.0));
+                }
+            }
+            resized.resize(rows / 2, cols / 3, policy);
+            CHECK(resized.size() == std::make_pair(rows / 2, cols / 3));
+        }
+    }
+}
+
+void testCompoundAssignment() {
+    for (auto const& shape : shapes) {
+        const int rows = shape.first;
+        const int cols = shape.second;
+        SmallMatrix lhs = patternMatrix(rows, cols, 6);
+        SmallMatrix rhs = patternMatrix(rows, cols, 7);
+        SmallMatrix multiplier = patternMatrix(cols, cols, 8);
+        for (ExecutionPolicy policy : policies) {
+            SmallMatrix sm = lhs;
+            CHECK(&sm.addAssign(rhs, policy) == &sm);
+            CHECK(sm == lhs + rhs);
+            sm.subtractAssign(rhs, policy);
+            CHECK(sm == lhs + rhs - rhs);
+            sm = lhs;
+            sm.multiplyAssign(multiplier, policy);
+            CHECK(sm == lhs * multiplier);
+            sm = lhs;
+            sm.multiplyAssign(2.5, policy);
+            CHECK(sm == 2.5 * lhs);
+
+            // Writes from several threads detach a shared copy-on-write buffer once
+            SmallMatrix shared = lhs;
+            shared.setCopyOnWrite(true);
+            SmallMatrix copy = shared;
+            copy.addAssign(rhs, policy);
+            CHECK(copy == lhs + rhs);
+            CHECK(shared == lhs);
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    testZeroInitialised();
+    testFreeFunctions();
+    testCopyAndResize();
+    testCompoundAssignment();
+}
@@ -0,0 +1,53 @@
+/**
+ * @file Fixtures.hpp
+ * @author Mohamad Baydoun
+ * @brief Test matrices, comparisons and file paths shared by the tests.
+ */
+#pragma once
+
+#include "SmallMatrix.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <string>
+
+/**
+ * @brief Returns a matrix of eighths in [-5/8, 5/8] that follows a different pattern for each seed.
+ *        Sums of products of the elements are exact, so results may be compared with ==.
+ */
+inline smallMatrix::SmallMatrix patternMatrix(int numRows, int numCols, int seed) {
+    smallMatrix::SmallMatrix sm = smallMatrix::SmallMatrix(numRows, numCols);
+    for (int i {}; i < numRows; i++) {
+        for (int j {}; j < numCols; j++) {
+            sm(i, j) = ((i * 7 + j * 3 + seed) % 11 - 5) / 8.0;
+        }
+    }
+    return sm;
+}
+
+/**
+ * @brief Returns true if the matrices have the same size and every element of lhs is within the
+ *        tolerance of rhs, relative to the magnitude of the element of rhs once it exceeds one.
+ */
+inline bool isClose(smallMatrix::SmallMatrix const& lhs, smallMatrix::SmallMatrix const& rhs, double tolerance) {
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+    for (int i {}; i < lhs.size().first; i++) {
+        for (int j {}; j < lhs.size().second; j++) {
+            if (std::abs(lhs(i, j) - rhs(i, j)) > tolerance * (1.0 + std::abs(rhs(i, j)))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Returns the path of the named file in the directory given by SMALL_MATRIX_TEST_DIR, or in
+ *        the working directory if it is not set.
+ */
+inline std::string testPath(std::string const& name) {
+    char const* directory = std::getenv("SMALL_MATRIX_TEST_DIR");
+    return std::string(directory != nullptr ? directory : ".") + "/" + name;
+}
@@ -0,0 +1,134 @@
+/*
+Tests for file-backed matrices and the out-of-core multiply.
+*/
+
+#include "MappedMatrix.hpp"
+#include "MatrixFuture.hpp"
+#include "tests/Check.hpp"
+#include "tests/Fixtures.hpp"
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace smallMatrix;
+
+namespace {
+
+// The streamed multiply gives the same result as the in-memory one, for edge tiles, single tiles
+// and empty matrices
+void testMultiply() {
+    struct Shape {
+        int numRows;
+        int numInner;
+        int numCols;
+        int tileSize;
+    };
+    const std::vector<Shape> shapes {{70, 45, 33, 16}, {1, 1, 1, 8}, {100, 100, 100, 32}, {64, 64, 64, 32}, {5, 0, 7, 4}, {0, 3, 3, 4}};
+    for (Shape const& shape : shapes) {
+        SmallMatrix lhs = patternMatrix(shape.numRows, shape.numInner, 1);
+        SmallMatrix rhs = patternMatrix(shape.numInner, shape.numCols, 2);
+        MappedMatrix mappedLhs(testPath("lhs.smm"), lhs, shape.tileSize);
+        MappedMatrix mappedRhs(testPath("rhs.smm"), rhs, shape.tileSize);
+        CHECK(mappedLhs.tileSize() == shape.tileSize);
+        CHECK(mappedLhs.toSmallMatrix() == lhs);
+
+        MappedMatrix product = multiply(mappedLhs, mappedRhs, testPath("product.smm"));
+        CHECK(product.toSmallMatrix() == lhs * rhs);
+        product.flush();
+
+        MappedMatrix reopened(testPath("product.smm"), false);
+        CHECK(reopened.size() == std::make_pair(shape.numRows, shape.numCols));
+        CHECK(reopened.toSmallMatrix() == lhs * rhs);
+    }
+}
+
+void testElementAccess() {
+    const std::string path = testPath("elements.smm");
+    {
+        MappedMatrix mm(path, 3, 4, 2);
+        CHECK(mm.path() == path);
+        mm(2, 3) = 5.0;
+        CHECK(mm(2, 3) == 5.0);
+        CHECK_THROWS(mm(3, 0), std::out_of_range);
+
+        MappedMatrix moved(std::move(mm));
+        CHECK(moved(2, 3) == 5.0);
+    }
+
+    // Changes are kept in the file after it is unmapped
+    MappedMatrix reopened(path);
+    CHECK(reopened(2, 3) == 5.0);
+    reopened = MappedMatrix(path, false);
+    MappedMatrix const& constReopened = reopened;
+    CHECK(constReopened(2, 3) == 5.0);
+    CHECK_THROWS(reopened(0, 0) = 1.0, std::runtime_error);
+}
+
+void testErrors() {
+    CHECK_THROWS(MappedMatrix(testPath("negative.smm"), -1, 2), std::out_of_range);
+    CHECK_THROWS(MappedMatrix(testPath("tile.smm"), 2, 2, 0), std::out_of_range);
+    CHECK_THROWS(MappedMatrix(testPath("missing.smm")), std::runtime_error);
+
+    const std::string textPath = testPath("not_a_matrix.smm");
+    std::ofstream(textPath) << "This is not a matrix file\n";
+    CHECK_THROWS(MappedMatrix(textPath), std::runtime_error);
+
+    MappedMatrix square(testPath("square.smm"), 4, 4, 2);
+    MappedMatrix otherTiles(testPath("other_tiles.smm"), 4, 4, 4);
+    MappedMatrix column(testPath("column.smm"), 3, 1, 2);
+    CHECK_THROWS(multiply(square, column, testPath("product.smm")), std::invalid_argument);
+    CHECK_THROWS(multiply(square, otherTiles, testPath("product.smm")), std::invalid_argument);
+    CHECK_THROWS(multiply(square, square, square.path()), std::invalid_argument);
+}
+
+// Writes the dimensions and tile size into the header of an existing matrix file
+void writeHeaderSizes(std::string const& path, std::int32_t numRows, std::int32_t numCols, std::int32_t tileSize) {
+    const std::int32_t sizes[] {numRows, numCols, tileSize};
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(12);
+    file.write(reinterpret_cast<char const*>(sizes), sizeof(sizes));
+}
+
+// A header whose sizes overflow when the size of the file is computed is rejected rather than read
+// out of bounds
+void testCorruptHeader() {
+    const std::string path = testPath("corrupt.smm");
+    const std::int32_t maxInt = std::numeric_limits<std::int32_t>::max();
+    const std::vector<std::vector<std::int32_t>> headers {
+        {maxInt, 1, 2}, {maxInt, maxInt, 1}, {1, 1, maxInt}, {maxInt, maxInt, maxInt}, {65536, 65536, 65536}};
+    for (std::vector<std::int32_t> const& header : headers) {
+        MappedMatrix(path, 4, 4, 2).flush();
+        writeHeaderSizes(path, header[0], header[1], header[2]);
+        CHECK_THROWS(MappedMatrix(path), std::runtime_error);
+    }
+
+    // The header is only trusted once the sizes are valid again
+    writeHeaderSizes(path, 4, 4, 2);
+    CHECK(MappedMatrix(path).size() == std::make_pair(4, 4));
+
+    CHECK_THROWS(MappedMatrix(testPath("huge.smm"), maxInt, maxInt, maxInt), std::runtime_error);
+}
+
+// Multiplying on a worker of the executor reads tiles on the same executor without deadlocking
+void testMultiplyOnExecutor() {
+    SmallMatrix sm = patternMatrix(40, 40, 3);
+    MappedMatrix mapped(testPath("async.smm"), sm, 8);
+    MatrixFuture product = computeAsync({}, [&]() {
+        return multiply(mapped, mapped, testPath("async_product.smm")).toSmallMatrix();
+    });
+    CHECK(product.get() == sm * sm);
+}
+
+}  // namespace
+
+int main() {
+    testMultiply();
+    testElementAccess();
+    testErrors();
+    testCorruptHeader();
+    testMultiplyOnExecutor();
+}
@@ -0,0 +1,84 @@
+/*
+Tests for the matrix-chain product and matrix powers.
+*/
+
+#include "SmallMatrix.hpp"
+#include "tests/Check.hpp"
+#include "tests/Fixtures.hpp"
+#include <functional>
+#include <vector>
+
+using namespace smallMatrix;
+
+namespace {
+
+// Multiplies the chain from left to right
+SmallMatrix leftToRight(std::vector<SmallMatrix> const& matrices) {
+    SmallMatrix product = matrices.front();
+    for (std::size_t i {1}; i < matrices.size(); i++) {
+        product = product * matrices.at(i);
+    }
+    return product;
+}
+
+std::vector<std::reference_wrapper<SmallMatrix const>> references(std::vector<SmallMatrix> const& matrices) {
+    return std::vector<std::reference_wrapper<SmallMatrix const>>(matrices.cbegin(), matrices.cend());
+}
+
+void testChainMatchesLeftToRight() {
+    const std::vector<int> dims {30, 2, 40, 5, 25, 3, 60, 4};
+    std::vector<SmallMatrix> matrices;
+    for (std::size_t i {}; i + 1 < dims.size(); i++) {
+        matrices.push_back(patternMatrix(dims.at(i), dims.at(i + 1), i));
+    }
+    CHECK(isClose(multiplyChain(references(matrices)), leftToRight(matrices), 1e-9));
+
+    std::vector<SmallMatrix> single {patternMatrix(3, 4, 1)};
+    CHECK(multiplyChain(references(single)) == single.front());
+}
+
+// A chain with increasing dimensions is split into a left-deep tree, one level per matrix
+void testLongChain() {
+    for (int numMatrices : {30, 300}) {
+        std::vector<SmallMatrix> matrices;
+        for (int i {}; i < numMatrices; i++) {
+            matrices.push_back(patternMatrix(2 + i % 40, 2 + (i + 1) % 40, i));
+        }
+        matrices.back() = patternMatrix(matrices.back().size().first, 3, 0);
+        CHECK(isClose(multiplyChain(references(matrices)), leftToRight(matrices), 1e-6));
+    }
+}
+
+void testChainErrors() {
+    std::vector<SmallMatrix> empty;
+    CHECK_THROWS(multiplyChain(references(empty)), std::invalid_argument);
+    std::vector<SmallMatrix> mismatched {patternMatrix(2, 3, 0), patternMatrix(4, 2, 0)};
+    CHECK_THROWS(multiplyChain(references(mismatched)), std::invalid_argument);
+}
+
+void testPow() {
+    SmallMatrix sm = patternMatrix(5, 5, 2);
+    SmallMatrix expected = SmallMatrix(5, 5);
+    for (int i {}; i < 5; i++) {
+        expected(i, i) = 1.0;
+    }
+    CHECK(pow(sm, 0) == expected);
+    for (int n {1}; n <= 9; n++) {
+        expected = expected * sm;
+        CHECK(isClose(pow(sm, n), expected, 1e-9));
+    }
+
+    SmallMatrix large = patternMatrix(20, 20, 3) * (1.0 / 8.0);
+    CHECK(isClose(pow(large, 5), large * large * large * large * large, 1e-9));
+    CHECK_THROWS(pow(patternMatrix(2, 3, 0), 2), std::invalid_argument);
+    CHECK_THROWS(pow(sm, -1), std::invalid_argument);
+}
+
+}  // namespace
+
+int main() {
+    testChainMatchesLeftToRight();
+    testLongChain();
+    testChainErrors();
+    testPow();
+}
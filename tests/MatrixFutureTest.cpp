@@ -0,0 +1,104 @@
+/*
+Tests for the executor, solve and the futures-based asynchronous operations.
+*/
+
+#include "Executor.hpp"
+#include "MatrixFuture.hpp"
+#include "tests/Check.hpp"
+#include "tests/Fixtures.hpp"
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using namespace smallMatrix;
+
+namespace {
+
+void testExecutor() {
+    std::atomic<int> numRun {0};
+    {
+        Executor executor(3);
+        CHECK(executor.numThreads() == 3);
+        for (int i {}; i < 100; i++) {
+            executor.submit([&numRun]() { numRun++; });
+        }
+        // The destructor runs every queued task before joining
+    }
+    CHECK(numRun == 100);
+    CHECK(Executor(0).numThreads() == 1);
+    CHECK(Executor::instance().numThreads() >= 1);
+}
+
+void testSolve() {
+    SmallMatrix lhs({{4, 1, 2}, {1, 5, 3}, {2, 3, 6}});
+    SmallMatrix rhs({{1}, {2}, {3}});
+    CHECK(isClose(lhs * solve(lhs, rhs), rhs, 1e-12));
+    CHECK(solve(SmallMatrix({{0, 1}, {1, 0}}), SmallMatrix({{2}, {3}})) == SmallMatrix({{3}, {2}}));
+
+    SmallMatrix large = SmallMatrix(200, 200);
+    for (int i {}; i < 200; i++) {
+        large(i, i) = 4.0;
+        if (i > 0) {
+            large(i, i - 1) = 1.0;
+        }
+    }
+    SmallMatrix columns = SmallMatrix(200, 3, 1.0);
+    CHECK(isClose(large * solve(large, columns), columns, 1e-12));
+
+    CHECK_THROWS(solve(SmallMatrix({{1, 2}, {2, 4}}), SmallMatrix({{1}, {1}})), std::invalid_argument);
+    CHECK_THROWS(solve(SmallMatrix(2, 3), SmallMatrix(2, 1)), std::invalid_argument);
+    CHECK_THROWS(solve(lhs, SmallMatrix(2, 1)), std::invalid_argument);
+}
+
+void testChainedFutures() {
+    SmallMatrix lhs({{4, 1, 2}, {1, 5, 3}, {2, 3, 6}});
+    SmallMatrix rhs({{1}, {2}, {3}});
+
+    MatrixFuture ready(lhs);
+    CHECK(ready.isReady());
+    CHECK(ready.get() == lhs);
+
+    MatrixFuture square = multiplyAsync(lhs, lhs);
+    MatrixFuture transposed = transposeAsync(square);
+    MatrixFuture solution = solveAsync(transposed, rhs);
+    MatrixFuture product = multiplyAsync(transposed, solution);
+    CHECK(isClose(product.get(), rhs, 1e-9));
+    CHECK(square.isReady() && transposed.isReady() && solution.isReady());
+
+    std::vector<MatrixFuture> futures;
+    SmallMatrix large = SmallMatrix(120, 120, 1.0);
+    for (int i {}; i < 50; i++) {
+        futures.push_back(multiplyAsync(large, large));
+    }
+    for (MatrixFuture const& future : futures) {
+        future.wait();
+        CHECK(future.get() == SmallMatrix(120, 120, 120.0));
+    }
+
+    MatrixFuture computed = computeAsync({square, large}, [&square]() { return square.get() * 2.0; });
+    CHECK(computed.get() == square.get() * 2.0);
+}
+
+// The exception of a failed operation reaches every future that depends on it
+void testErrorPropagation() {
+    SmallMatrix lhs({{4, 1, 2}, {1, 5, 3}, {2, 3, 6}});
+    SmallMatrix rhs({{1}, {2}, {3}});
+    MatrixFuture column = multiplyAsync(lhs, rhs);
+    MatrixFuture invalid = multiplyAsync(column, rhs);
+    MatrixFuture dependent = transposeAsync(invalid);
+    CHECK_THROWS(dependent.get(), std::invalid_argument);
+    CHECK(invalid.isReady());
+    CHECK_THROWS(invalid.get(), std::invalid_argument);
+
+    MatrixFuture failed = computeAsync({}, []() -> SmallMatrix { throw std::runtime_error("Failed!"); });
+    CHECK_THROWS(failed.get(), std::runtime_error);
+}
+
+}  // namespace
+
+int main() {
+    testExecutor();
+    testSolve();
+    testChainedFutures();
+    testErrorPropagation();
+}
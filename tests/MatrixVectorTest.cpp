@@ -0,0 +1,82 @@
+/*
+Tests for the matrix-vector kernels and batched point transforms.
+*/
+
+#include "SmallMatrix.hpp"
+#include "tests/Check.hpp"
+#include <stdexcept>
+#include <vector>
+
+using namespace smallMatrix;
+
+namespace {
+
+void testProducts() {
+    SmallMatrix sm({{1, 2, 3}, {4, 5, 6}});
+    CHECK((sm * std::vector<double> {1, 1, 2} == std::vector<double> {9, 21}));
+    CHECK((multiplyTransposed(sm, {1, 2}) == std::vector<double> {9, 12, 15}));
+    CHECK(outerProduct({1, 2}, {3, 4, 5}) == SmallMatrix({{3, 4, 5}, {6, 8, 10}}));
+
+    sm.addOuterProduct(2.0, {1, 0}, {1, 1, 1});
+    CHECK(sm == SmallMatrix({{3, 4, 5}, {4, 5, 6}}));
+
+    SmallMatrix large = SmallMatrix(200, 150, 1.0);
+    CHECK((large * std::vector<double>(150, 1.0) == std::vector<double>(200, 150.0)));
+    CHECK((multiplyTransposed(large, std::vector<double>(200, 0.5)) == std::vector<double>(150, 100.0)));
+
+    CHECK_THROWS(sm * std::vector<double> {1}, std::invalid_argument);
+    CHECK_THROWS(multiplyTransposed(sm, {1, 2, 3}), std::invalid_argument);
+    CHECK_THROWS(sm.addOuterProduct(1.0, {1}, {1, 1, 1}), std::invalid_argument);
+}
+
+void testOutputVector() {
+    SmallMatrix sm({{1, 2, 3}, {4, 5, 6}});
+    const std::vector<double> x {1, 1, 2};
+
+    // The output is resized, and its storage is reused once it is large enough
+    std::vector<double> out(10, -1.0);
+    double const* storage = out.data();
+    multiply(sm, x, out);
+    CHECK((out == std::vector<double> {9, 21}));
+    CHECK(out.data() == storage);
+    multiplyTransposed(sm, {1, 2}, out);
+    CHECK((out == std::vector<double> {9, 12, 15}));
+    CHECK(out.data() == storage);
+
+    std::vector<double> empty;
+    multiply(sm, x, empty);
+    CHECK(empty == sm * x);
+
+    std::vector<double> same {1, 2, 3};
+    CHECK_THROWS(multiply(sm, same, same), std::invalid_argument);
+    std::vector<double> sameRows {1, 2};
+    CHECK_THROWS(multiplyTransposed(sm, sameRows, sameRows), std::invalid_argument);
+    CHECK_THROWS(multiply(sm, {1}, out), std::invalid_argument);
+}
+
+void testTransformPoints() {
+    SmallMatrix sm({{1, 2, 3}, {4, 5, 6}});
+    std::vector<double> points(300000);
+    for (std::size_t i {}; i < points.size(); i++) {
+        points[i] = i % 7;
+    }
+
+    std::vector<double> results = sm.transformPoints(points);
+    CHECK(results.size() == 200000);
+    for (int p {}; p < 100000; p += 977) {
+        std::vector<double> expected = sm * std::vector<double>(points.cbegin() + 3 * p, points.cbegin() + 3 * p + 3);
+        CHECK(results[2 * p] == expected[0] && results[2 * p + 1] == expected[1]);
+    }
+
+    CHECK(sm.transformPoints(std::vector<double> {}).empty());
+    CHECK_THROWS(sm.transformPoints(std::vector<double> {1, 2}), std::invalid_argument);
+    CHECK_THROWS(sm.transformPoints(points.data(), results.data(), -1), std::invalid_argument);
+}
+
+}  // namespace
+
+int main() {
+    testProducts();
+    testOutputVector();
+    testTransformPoints();
+}
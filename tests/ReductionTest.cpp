@@ -0,0 +1,88 @@
+/*
+Tests for the reductions and the element-wise map and zip.
+*/
+
+#include "SmallMatrix.hpp"
+#include "tests/Check.hpp"
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using namespace smallMatrix;
+
+namespace {
+
+const std::vector<ExecutionPolicy> policies {
+    ExecutionPolicy::Sequential, ExecutionPolicy::Parallel, ExecutionPolicy::ThreadPool};
+
+void testSmallReductions() {
+    SmallMatrix sm({{1, -2, 3}, {4, 5, -6}});
+    CHECK(sm.sum() == 5.0);
+    CHECK(sm.min() == -6.0);
+    CHECK(sm.max() == 5.0);
+    CHECK(sm.argMin() == std::make_pair(1, 2));
+    CHECK(sm.argMax() == std::make_pair(1, 1));
+    CHECK(std::abs(sm.frobeniusNorm() - std::sqrt(91.0)) < 1e-12);
+    CHECK(sm.infinityNorm() == 15.0);
+
+    CHECK(SmallMatrix(3, 3, 1.0).trace() == 3.0);
+    CHECK_THROWS(sm.trace(), std::invalid_argument);
+    CHECK_THROWS(SmallMatrix().max(), std::out_of_range);
+    CHECK_THROWS(SmallMatrix().argMin(), std::out_of_range);
+    CHECK(SmallMatrix().sum() == 0.0);
+}
+
+// Every policy adds the elements in the same order, so the results are identical
+void testLargeReductions() {
+    SmallMatrix sm = SmallMatrix(700, 500, 0.1);
+    sm(699, 499) = 7.0;
+    sm(5, 5) = -3.0;
+    sm(600, 2) = 7.0;
+
+    const double sum = sm.sum(ExecutionPolicy::Sequential);
+    CHECK(std::abs(sum - (0.1 * 349997 + 11.0)) < 1e-6);
+    for (ExecutionPolicy policy : policies) {
+        CHECK(sm.sum(policy) == sum);
+        CHECK(sm.frobeniusNorm(policy) == sm.frobeniusNorm(ExecutionPolicy::Sequential));
+        CHECK(sm.infinityNorm(policy) == sm.infinityNorm(ExecutionPolicy::Sequential));
+        CHECK(sm.min(policy) == -3.0);
+        CHECK(sm.max(policy) == 7.0);
+        CHECK(sm.argMin(policy) == std::make_pair(5, 5));
+        // The first of equal elements in row-major order is returned
+        CHECK(sm.argMax(policy) == std::make_pair(600, 2));
+    }
+}
+
+void testMapAndZip() {
+    SmallMatrix sm({{1, -2, 3}, {4, 5, -6}});
+    SmallMatrix doubled = sm.map([](double x) { return 2.0 * x; });
+    CHECK(doubled == 2.0 * sm);
+    CHECK(zip(sm, doubled, [](double x, double y) { return x + y; }) == 3.0 * sm);
+    CHECK_THROWS(zip(sm, SmallMatrix(3, 2), [](double x, double y) { return x + y; }), std::invalid_argument);
+
+    SmallMatrix large = SmallMatrix(400, 300, 1.5);
+    for (ExecutionPolicy policy : policies) {
+        CHECK(large.map([](double x) { return x * x; }, policy) == SmallMatrix(400, 300, 2.25));
+        CHECK(zip(large, large, [](double x, double y) { return x - y; }, policy) == SmallMatrix(400, 300));
+    }
+
+    // An exception thrown by the function reaches the caller, whichever thread ran it
+    large(399, 299) = 10.0;
+    for (ExecutionPolicy policy : policies) {
+        CHECK_THROWS(large.map([](double x) {
+            if (x > 5.0) {
+                throw std::runtime_error("Too large!");
+            }
+            return x;
+        }, policy), std::runtime_error);
+    }
+}
+
+}  // namespace
+
+int main() {
+    testSmallReductions();
+    testLargeReductions();
+    testMapAndZip();
+}
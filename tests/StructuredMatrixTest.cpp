@@ -0,0 +1,144 @@
+/*
+Tests that the diagonal, triangular, symmetric and banded types agree with their dense form.
+*/
+
+#include "StructuredMatrix.hpp"
+#include "tests/Check.hpp"
+#include "tests/Fixtures.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+using namespace smallMatrix;
+
+namespace {
+
+const std::vector<int> sizes {1, 5, 13, 40, 150};
+
+// Returns scale times the identity, which makes a pattern matrix diagonally dominant when added to
+// it, so that every structured part of the sum is non-singular
+SmallMatrix scaledIdentity(int size, double scale) {
+    SmallMatrix sm = SmallMatrix(size, size);
+    for (int i {}; i < size; i++) {
+        sm(i, i) = scale;
+    }
+    return sm;
+}
+
+double maxDifference(SmallMatrix const& lhs, SmallMatrix const& rhs) {
+    CHECK(lhs.size() == rhs.size());
+    double difference {};
+    for (int i {}; i < lhs.size().first; i++) {
+        for (int j {}; j < lhs.size().second; j++) {
+            difference = std::max(difference, std::abs(lhs(i, j) - rhs(i, j)));
+        }
+    }
+    return difference;
+}
+
+double maxDifference(std::vector<double> const& lhs, std::vector<double> const& rhs) {
+    CHECK(lhs.size() == rhs.size());
+    double difference {};
+    for (std::size_t i {}; i < lhs.size(); i++) {
+        difference = std::max(difference, std::abs(lhs[i] - rhs[i]));
+    }
+    return difference;
+}
+
+std::vector<double> patternVector(int size) {
+    std::vector<double> x(size);
+    for (int i {}; i < size; i++) {
+        x[i] = (i % 5 - 2) / 4.0;
+    }
+    return x;
+}
+
+void testDiagonal() {
+    for (int n : sizes) {
+        SmallMatrix rhs = patternMatrix(n, 3, 1);
+        DiagonalMatrix dm(patternMatrix(n, n, 2) + scaledIdentity(n, n));
+        SmallMatrix dense = dm.toSmallMatrix();
+        CHECK(maxDifference(dm * rhs, dense * rhs) < 1e-9);
+        CHECK(maxDifference(transpose(rhs) * dm, transpose(rhs) * dense) < 1e-9);
+        CHECK(maxDifference(dm * patternVector(n), dense * patternVector(n)) < 1e-9);
+        CHECK(maxDifference(solve(dm, rhs), solve(dense, rhs)) < 1e-9);
+        CHECK(maxDifference((dm * dm).toSmallMatrix(), dense * dense) < 1e-9);
+    }
+    CHECK(DiagonalMatrix(std::vector<double> {1, 2})(0, 1) == 0.0);
+    CHECK_THROWS(solve(DiagonalMatrix(3), SmallMatrix(3, 1)), std::invalid_argument);
+}
+
+void testTriangular() {
+    for (int n : sizes) {
+        SmallMatrix rhs = patternMatrix(n, 3, 3);
+        for (Triangle triangle : {Triangle::Lower, Triangle::Upper}) {
+            TriangularMatrix tm(patternMatrix(n, n, 4) + scaledIdentity(n, n), triangle);
+            SmallMatrix dense = tm.toSmallMatrix();
+            CHECK(tm.triangle() == triangle);
+            CHECK(maxDifference(tm * rhs, dense * rhs) < 1e-9);
+            CHECK(maxDifference(tm * patternVector(n), dense * patternVector(n)) < 1e-9);
+            CHECK(maxDifference(solve(tm, rhs), solve(dense, rhs)) < 1e-8);
+            CHECK(transpose(tm).toSmallMatrix() == transpose(dense));
+        }
+    }
+    TriangularMatrix lower(3, Triangle::Lower);
+    TriangularMatrix const& constLower = lower;
+    CHECK(constLower(0, 2) == 0.0);
+    CHECK_THROWS(lower(0, 2) = 1.0, std::out_of_range);
+}
+
+void testSymmetric() {
+    for (int n : sizes) {
+        SmallMatrix rhs = patternMatrix(n, 3, 5);
+        SmallMatrix sm = patternMatrix(n, n, 6) + scaledIdentity(n, n);
+        SmallMatrix dense = sm + transpose(sm);
+        SymmetricMatrix symmetric(dense);
+        CHECK(symmetric.toSmallMatrix() == dense);
+        CHECK(maxDifference(symmetric * rhs, dense * rhs) < 1e-9);
+        CHECK(maxDifference(symmetric * patternVector(n), dense * patternVector(n)) < 1e-9);
+        CHECK(maxDifference(solve(symmetric, rhs), solve(dense, rhs)) < 1e-8);
+        CHECK(transpose(symmetric).toSmallMatrix() == dense);
+
+        // Writing one element also writes its mirror
+        symmetric(n - 1, 0) = 9.0;
+        CHECK(symmetric(0, n - 1) == 9.0);
+    }
+}
+
+void testBanded() {
+    for (int n : sizes) {
+        SmallMatrix rhs = patternMatrix(n, 3, 7);
+        for (int numLower : {0, 1, 3}) {
+            for (int numUpper : {0, 2, 5}) {
+                BandedMatrix banded(patternMatrix(n, n, 8) + scaledIdentity(n, n), numLower, numUpper);
+                SmallMatrix dense = banded.toSmallMatrix();
+                CHECK(banded.bandwidth() == std::make_pair(numLower, numUpper));
+                CHECK(maxDifference(banded * rhs, dense * rhs) < 1e-9);
+                CHECK(maxDifference(banded * patternVector(n), dense * patternVector(n)) < 1e-9);
+                CHECK(maxDifference(solve(banded, rhs), solve(dense, rhs)) < 1e-8);
+                CHECK(transpose(banded).toSmallMatrix() == transpose(dense));
+            }
+        }
+    }
+
+    // A zero on the diagonal needs row interchanges within the band
+    BandedMatrix pivoted(3, 1, 1);
+    pivoted(0, 1) = 1.0;
+    pivoted(1, 0) = 1.0;
+    pivoted(1, 2) = 1.0;
+    pivoted(2, 1) = 1.0;
+    pivoted(2, 2) = 1.0;
+    SmallMatrix rhs({{1}, {2}, {3}});
+    CHECK(maxDifference(solve(pivoted, rhs), solve(pivoted.toSmallMatrix(), rhs)) < 1e-12);
+    CHECK_THROWS(pivoted(0, 2) = 1.0, std::out_of_range);
+}
+
+}  // namespace
+
+int main() {
+    testDiagonal();
+    testTriangular();
+    testSymmetric();
+    testBanded();
+}
@@ -0,0 +1,65 @@
+/*
+Tests for tiled storage in row-major and Morton tile order.
+*/
+
+#include "TiledMatrix.hpp"
+#include "tests/Check.hpp"
+#include "tests/Fixtures.hpp"
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+using namespace smallMatrix;
+
+namespace {
+
+void testRoundTrip() {
+    for (TileOrder order : {TileOrder::RowMajor, TileOrder::Morton}) {
+        SmallMatrix sm = patternMatrix(70, 45, 1);
+        TiledMatrix tm(sm, order);
+        CHECK(tm.order() == order);
+        CHECK(tm.size() == std::make_pair(70, 45));
+        CHECK(tm.toSmallMatrix() == sm);
+        CHECK(tm(69, 44) == sm(69, 44));
+
+        tm(3, 4) = 100.0;
+        CHECK(tm.toSmallMatrix()(3, 4) == 100.0);
+        CHECK_THROWS(tm(70, 0), std::out_of_range);
+        CHECK_THROWS(tm(0, -1), std::out_of_range);
+    }
+
+    TiledMatrix empty;
+    CHECK(empty.size() == std::make_pair(0, 0));
+    CHECK(TiledMatrix(SmallMatrix(2, 2, 1.0)).toSmallMatrix() == SmallMatrix(2, 2, 1.0));
+    CHECK(TiledMatrix(5, 3).toSmallMatrix() == SmallMatrix(5, 3));
+}
+
+void testOperations() {
+    for (TileOrder order : {TileOrder::RowMajor, TileOrder::Morton}) {
+        SmallMatrix lhs = patternMatrix(70, 45, 2);
+        SmallMatrix rhs = patternMatrix(45, 100, 3);
+        TiledMatrix tiledLhs(lhs, order);
+        TiledMatrix tiledRhs(rhs, order);
+        CHECK((tiledLhs * tiledRhs).toSmallMatrix() == lhs * rhs);
+        for (ExecutionPolicy policy : {ExecutionPolicy::Sequential, ExecutionPolicy::Parallel, ExecutionPolicy::ThreadPool}) {
+            CHECK(multiply(tiledLhs, tiledRhs, policy).toSmallMatrix() == lhs * rhs);
+        }
+        CHECK(transpose(tiledLhs).toSmallMatrix() == transpose(lhs));
+        CHECK_THROWS(tiledLhs * tiledLhs, std::invalid_argument);
+    }
+}
+
+// Negative sizes are rejected before the tile counts are computed from them
+void testInvalidSizes() {
+    CHECK_THROWS(TiledMatrix(-1, 4), std::out_of_range);
+    CHECK_THROWS(TiledMatrix(4, -1), std::out_of_range);
+    CHECK_THROWS(TiledMatrix(std::numeric_limits<int>::min(), 4), std::out_of_range);
+}
+
+}  // namespace
+
+int main() {
+    testRoundTrip();
+    testOperations();
+    testInvalidSizes();
+}
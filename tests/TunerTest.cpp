@@ -0,0 +1,162 @@
+/*
+Tests for the tuner: first use, cache files and the equivalence of every tuned kernel.
+*/
+
+#include "SmallMatrix.hpp"
+#include "Tuner.hpp"
+#include "tests/Check.hpp"
+#include "tests/Fixtures.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using namespace smallMatrix;
+
+namespace {
+
+bool isFile(std::string const& path) {
+    return std::ifstream(path).good();
+}
+
+bool isEqual(TuningParameters const& lhs, TuningParameters const& rhs) {
+    return lhs.multiplyBlockSize == rhs.multiplyBlockSize && lhs.multiplyKernel == rhs.multiplyKernel &&
+           lhs.transposeBlockSize == rhs.transposeBlockSize && lhs.parallelThreshold == rhs.parallelThreshold &&
+           lhs.copyParallelThreshold == rhs.copyParallelThreshold &&
+           lhs.transposeParallelThreshold == rhs.transposeParallelThreshold &&
+           lhs.multiplyParallelThreshold == rhs.multiplyParallelThreshold;
+}
+
+// Must run before anything else uses the parameters
+void testFirstUseKeepsDefaults() {
+    const std::string path = testPath("first_use_cache");
+    std::remove(path.c_str());
+    setenv("SMALL_MATRIX_TUNING_CACHE", path.c_str(), 1);
+    unsetenv("SMALL_MATRIX_AUTOTUNE");
+
+    CHECK(isEqual(Tuner::parameters(), TuningParameters()));
+    CHECK(!isFile(path));
+}
+
+void testCachePath() {
+    setenv("SMALL_MATRIX_TUNING_CACHE", "/tmp/explicit_cache", 1);
+    setenv("XDG_CACHE_HOME", "/tmp/xdg", 1);
+    setenv("HOME", "/tmp/home", 1);
+    CHECK(Tuner::cachePath() == "/tmp/explicit_cache");
+
+    unsetenv("SMALL_MATRIX_TUNING_CACHE");
+    CHECK(Tuner::cachePath() == "/tmp/xdg/small_matrix_tuning");
+
+    // Relative values of XDG_CACHE_HOME are ignored, as the specification requires
+    setenv("XDG_CACHE_HOME", "relative", 1);
+    CHECK(Tuner::cachePath() == "/tmp/home/.cache/small_matrix_tuning");
+    unsetenv("XDG_CACHE_HOME");
+    CHECK(Tuner::cachePath() == "/tmp/home/.cache/small_matrix_tuning");
+
+    unsetenv("HOME");
+    CHECK(Tuner::cachePath().empty());
+}
+
+void testKernelsAgree() {
+    SmallMatrix lhs = patternMatrix(137, 91, 1);
+    SmallMatrix rhs = patternMatrix(91, 203, 2);
+    Tuner::setParameters(TuningParameters());
+    SmallMatrix product = multiply(lhs, rhs, ExecutionPolicy::Sequential);
+    SmallMatrix transposed = transpose(lhs, ExecutionPolicy::Sequential);
+
+    for (MultiplyKernel kernel : {MultiplyKernel::Blocked, MultiplyKernel::RegisterTiled}) {
+        for (int blockSize : {1, 3, 16, 64, 300}) {
+            for (int tileSize : {1, 7, 32, 200}) {
+                TuningParameters parameters;
+                parameters.multiplyKernel = kernel;
+                parameters.multiplyBlockSize = blockSize;
+                parameters.transposeBlockSize = tileSize;
+                parameters.multiplyParallelThreshold = 1;
+                parameters.transposeParallelThreshold = 1;
+                Tuner::setParameters(parameters);
+                CHECK(lhs * rhs == product);
+                CHECK(multiply(lhs, rhs, ExecutionPolicy::ThreadPool) == product);
+                CHECK(transpose(lhs) == transposed);
+            }
+        }
+    }
+    Tuner::setParameters(TuningParameters());
+}
+
+void testInvalidParameters() {
+    TuningParameters parameters;
+    parameters.multiplyBlockSize = 0;
+    CHECK_THROWS(Tuner::setParameters(parameters), std::invalid_argument);
+    parameters = TuningParameters();
+    parameters.copyParallelThreshold = -1;
+    CHECK_THROWS(Tuner::setParameters(parameters), std::invalid_argument);
+}
+
+void testSaveAndLoad() {
+    const std::string path = testPath("round_trip_cache");
+    TuningParameters parameters;
+    parameters.multiplyKernel = MultiplyKernel::RegisterTiled;
+    parameters.multiplyBlockSize = 48;
+    parameters.copyParallelThreshold = 12345;
+    Tuner::setParameters(parameters);
+    Tuner::save(path);
+
+    Tuner::setParameters(TuningParameters());
+    CHECK(Tuner::load(path));
+    CHECK(isEqual(Tuner::parameters(), parameters));
+
+    // A cache written on another host is ignored
+    std::ifstream file(path);
+    std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    contents.replace(contents.find("host ") + 5, 1, "#");
+    const std::string otherHostPath = testPath("other_host_cache");
+    std::ofstream(otherHostPath) << contents;
+    CHECK(!Tuner::load(otherHostPath));
+    CHECK(!Tuner::load(testPath("missing_cache")));
+    CHECK_THROWS(Tuner::save("/nonexistent_directory/cache"), std::runtime_error);
+    Tuner::setParameters(TuningParameters());
+}
+
+// Parameters replaced by another thread never change the result of an operation
+void testConcurrentReplacement() {
+    SmallMatrix lhs = patternMatrix(137, 91, 3);
+    SmallMatrix rhs = patternMatrix(91, 203, 4);
+    SmallMatrix product = multiply(lhs, rhs, ExecutionPolicy::Sequential);
+
+    std::thread writer([] {
+        for (int i {}; i < 50; i++) {
+            TuningParameters parameters;
+            parameters.multiplyBlockSize = 8 + i % 3 * 24;
+            parameters.multiplyKernel = i % 2 == 0 ? MultiplyKernel::RegisterTiled : MultiplyKernel::Blocked;
+            parameters.multiplyParallelThreshold = 1 + i % 2 * 1000000;
+            Tuner::setParameters(parameters);
+        }
+    });
+    for (int i {}; i < 20; i++) {
+        CHECK(lhs * rhs == product);
+    }
+    writer.join();
+    Tuner::setParameters(TuningParameters());
+}
+
+void testTune() {
+    const TuningParameters tuned = Tuner::tune();
+    CHECK(isEqual(Tuner::parameters(), tuned));
+    CHECK(tuned.multiplyBlockSize > 0 && tuned.transposeBlockSize > 0);
+    Tuner::setParameters(TuningParameters());
+}
+
+}  // namespace
+
+int main() {
+    testFirstUseKeepsDefaults();
+    testCachePath();
+    testKernelsAgree();
+    testInvalidParameters();
+    testSaveAndLoad();
+    testConcurrentReplacement();
+    testTune();
+}
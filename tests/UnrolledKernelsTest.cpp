@@ -0,0 +1,126 @@
+/*
+Tests for the unrolled kernels used by 2x2 to 8x8 matrices.
+*/
+
+#include "SmallMatrix.hpp"
+#include "tests/Check.hpp"
+#include <random>
+
+using namespace smallMatrix;
+
+namespace {
+
+std::mt19937 generator(37);
+
+SmallMatrix randomMatrix(int numRows, int numCols) {
+    std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+    SmallMatrix sm = SmallMatrix(numRows, numCols);
+    for (int i {}; i < numRows; i++) {
+        for (int j {}; j < numCols; j++) {
+            sm(i, j) = distribution(generator);
+        }
+    }
+    return sm;
+}
+
+bool isIdentical(SmallMatrix const& lhs, SmallMatrix const& rhs) {
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+    for (int i {}; i < lhs.size().first; i++) {
+        for (int j {}; j < lhs.size().second; j++) {
+            if (lhs(i, j) != rhs(i, j)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Adds the products for each element in k order, as both kernels do
+SmallMatrix referenceProduct(SmallMatrix const& lhs, SmallMatrix const& rhs) {
+    SmallMatrix product = SmallMatrix(lhs.size().first, rhs.size().second);
+    for (int i {}; i < lhs.size().first; i++) {
+        for (int k {}; k < lhs.size().second; k++) {
+            for (int j {}; j < rhs.size().second; j++) {
+                product(i, j) += lhs(i, k) * rhs(k, j);
+            }
+        }
+    }
+    return product;
+}
+
+// Covers every shape with an unrolled kernel, and the sizes just outside the range
+void testShapes() {
+    for (int rows {1}; rows <= 9; rows++) {
+        for (int inner {1}; inner <= 9; inner++) {
+            for (int cols {1}; cols <= 9; cols++) {
+                SmallMatrix lhs = randomMatrix(rows, inner);
+                SmallMatrix rhs = randomMatrix(inner, cols);
+                CHECK(isIdentical(lhs * rhs, referenceProduct(lhs, rhs)));
+                SmallMatrix product = lhs;
+                product *= rhs;
+                CHECK(isIdentical(product, referenceProduct(lhs, rhs)));
+            }
+        }
+    }
+
+    for (int rows {1}; rows <= 9; rows++) {
+        for (int cols {1}; cols <= 9; cols++) {
+            SmallMatrix lhs = randomMatrix(rows, cols);
+            SmallMatrix rhs = randomMatrix(rows, cols);
+            SmallMatrix sum = lhs + rhs;
+            SmallMatrix transposed = transpose(lhs);
+            for (int i {}; i < rows; i++) {
+                for (int j {}; j < cols; j++) {
+                    CHECK(sum(i, j) == lhs(i, j) + rhs(i, j));
+                    CHECK(transposed(j, i) == lhs(i, j));
+                }
+            }
+
+            SmallMatrix nearlyEqual = lhs;
+            nearlyEqual(rows - 1, cols - 1) += 1e-9;
+            CHECK(lhs == nearlyEqual);
+            nearlyEqual(0, 0) += 1e-3;
+            CHECK(lhs != nearlyEqual);
+            CHECK(lhs != rhs);
+            CHECK(lhs != randomMatrix(rows, cols + 1));
+            CHECK_THROWS(lhs + randomMatrix(rows + 1, cols), std::invalid_argument);
+        }
+    }
+    CHECK_THROWS(randomMatrix(3, 4) * randomMatrix(3, 4), std::invalid_argument);
+}
+
+// A large matrix shrunk to a small shape keeps its heap storage, so it must not use the kernels
+// that read the stack array
+void testShrunkHeapMatrix() {
+    SmallMatrix shrunk = SmallMatrix(20, 20, 1.0);
+    shrunk.resize(4, 4);
+    CHECK(!shrunk.isSmall());
+    SmallMatrix ones = SmallMatrix(4, 4, 1.0);
+
+    CHECK((shrunk + ones)(0, 0) == 2.0);
+    CHECK((ones + shrunk)(3, 3) == 2.0);
+    CHECK((shrunk * ones)(0, 0) == 4.0);
+    CHECK((ones * shrunk)(3, 3) == 4.0);
+    CHECK(transpose(shrunk)(0, 0) == 1.0);
+    CHECK(shrunk == ones);
+    CHECK(ones == shrunk);
+
+    SmallMatrix product = ones;
+    product *= shrunk;
+    CHECK(product == SmallMatrix(4, 4, 4.0));
+
+    SmallMatrix erased = SmallMatrix(13, 12, 2.0);
+    erased.resize(5, 3);
+    CHECK(!erased.isSmall());
+    CHECK(transpose(erased) == SmallMatrix(3, 5, 2.0));
+    CHECK(erased * transpose(erased) == SmallMatrix(5, 5, 12.0));
+}
+
+}  // namespace
+
+int main() {
+    testShapes();
+    testShrunkHeapMatrix();
+}
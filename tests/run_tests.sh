@@ -0,0 +1,33 @@
+#!/bin/sh
+# Builds the library once, then builds and runs every tests/*Test.cpp against it.
+# Extra compiler flags, e.g. sanitizers, can be passed in CXXFLAGS.
+set -e
+
+root="$(cd "$(dirname "$0")/.." && pwd)"
+build="${BUILD_DIR:-$root/_test_build}"
+flags="-std=c++14 -O2 -g -pthread -I$root $CXXFLAGS"
+mkdir -p "$build"
+
+# Tests must not read or write the tuning cache of the user
+export SMALL_MATRIX_TUNING_CACHE="$build/tuning_cache"
+export SMALL_MATRIX_TEST_DIR="$build"
+unset SMALL_MATRIX_AUTOTUNE
+
+objects=""
+for source in SmallMatrix Executor MatrixFuture TiledMatrix MappedMatrix StructuredMatrix Tuner; do
+    g++ $flags -c "$root/$source.cpp" -o "$build/$source.o"
+    objects="$objects $build/$source.o"
+done
+
+failed=0
+for test in "$root"/tests/*Test.cpp; do
+    name="$(basename "$test" .cpp)"
+    g++ $flags "$test" $objects -o "$build/$name"
+    if "$build/$name"; then
+        echo "PASS $name"
+    else
+        echo "FAIL $name"
+        failed=1
+    fi
+done
+exit $failed